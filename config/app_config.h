@@ -30,6 +30,46 @@
 #ifndef APP_CONFIG_H
 #define APP_CONFIG_H
 
+#include "irq_priorities.h"
+
+// <h> Interrupt priorities - taken from irq_priorities.h
+//==========================================================
+#define NRFX_SPIM_DEFAULT_CONFIG_IRQ_PRIORITY IRQ_PRIO_SPIM0
+#define SPI_DEFAULT_CONFIG_IRQ_PRIORITY IRQ_PRIO_SPIM0
+#define NRFX_PWM_DEFAULT_CONFIG_IRQ_PRIORITY IRQ_PRIO_PWM0
+#define PWM_DEFAULT_CONFIG_IRQ_PRIORITY IRQ_PRIO_PWM0
+#define APP_TIMER_CONFIG_IRQ_PRIORITY IRQ_PRIO_APP_TIMER
+#define NRFX_USBD_CONFIG_IRQ_PRIORITY IRQ_PRIO_USBD
+#define USBD_CONFIG_IRQ_PRIORITY IRQ_PRIO_USBD
+#define NRFX_POWER_CONFIG_IRQ_PRIORITY IRQ_PRIO_POWER_CLOCK
+#define POWER_CONFIG_IRQ_PRIORITY IRQ_PRIO_POWER_CLOCK
+#define NRFX_CLOCK_CONFIG_IRQ_PRIORITY IRQ_PRIO_POWER_CLOCK
+#define CLOCK_CONFIG_IRQ_PRIORITY IRQ_PRIO_POWER_CLOCK
+// </h>
+
+// <q> PPI_ENABLED - nrf_drv_ppi - PPI peripheral driver - legacy layer
+#ifndef PPI_ENABLED
+#define PPI_ENABLED 1
+#endif
+
+#ifndef NRFX_PPI_ENABLED
+#define NRFX_PPI_ENABLED 1
+#endif
+
+// <e> NRF_LOG_USES_TIMESTAMP - Enable timestamping
+// <i> Timestamps come from hires_clock (TIMER3). It keeps HFCLK running,
+// <i> which the USB log backend needs anyway.
+//==========================================================
+#ifndef NRF_LOG_USES_TIMESTAMP
+#define NRF_LOG_USES_TIMESTAMP 1
+#endif
+// <o> NRF_LOG_TIMESTAMP_DEFAULT_FREQUENCY - Frequency of the timestamp (in Hz)
+#ifndef NRF_LOG_TIMESTAMP_DEFAULT_FREQUENCY
+#define NRF_LOG_TIMESTAMP_DEFAULT_FREQUENCY 16000000
+#endif
+
+// </e>
+
 // <e> NRF_LOG_BACKEND_UART_ENABLED - nrf_log_backend_uart - Log UART backend
 //==========================================================
 #ifndef NRF_LOG_BACKEND_UART_ENABLED
@@ -127,4 +167,750 @@
 
 // </e>
 
+// <h> Log levels
+// <i> Compile-time ceilings of the application modules. Log sites more
+// <i> verbose than the ceiling of their module are removed from the build.
+// <i> Runtime overrides below the ceilings are in log_levels.c.
+//==========================================================
+// <o> NRF_LOG_DEFAULT_LEVEL - Global ceiling, over the module settings too
+// <i> The logger drops every site above it, whatever the level of its module,
+// <i> so it stays at Debug and the modules below default to Info. Lowering it
+// <i> caps all of them; a module set to Debug needs it at Debug.
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef NRF_LOG_DEFAULT_LEVEL
+#define NRF_LOG_DEFAULT_LEVEL 4
+#endif
+
+// <o> MAIN_CONFIG_LOG_LEVEL - app (main.c)
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef MAIN_CONFIG_LOG_LEVEL
+#define MAIN_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> CONTROL_CONFIG_LOG_LEVEL - control
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef CONTROL_CONFIG_LOG_LEVEL
+#define CONTROL_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> CRASH_LOG_CONFIG_LOG_LEVEL - crash_log
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef CRASH_LOG_CONFIG_LOG_LEVEL
+#define CRASH_LOG_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> DISPLAY_MUX_CONFIG_LOG_LEVEL - display_mux
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef DISPLAY_MUX_CONFIG_LOG_LEVEL
+#define DISPLAY_MUX_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> DSP_CONFIG_LOG_LEVEL - dsp
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef DSP_CONFIG_LOG_LEVEL
+#define DSP_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> IDLE_CONFIG_LOG_LEVEL - idle
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef IDLE_CONFIG_LOG_LEVEL
+#define IDLE_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> IRQ_LATENCY_CONFIG_LOG_LEVEL - irq_latency
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef IRQ_LATENCY_CONFIG_LOG_LEVEL
+#define IRQ_LATENCY_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> LOG_BACKEND_BIN_CONFIG_LOG_LEVEL - log_backend_bin
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef LOG_BACKEND_BIN_CONFIG_LOG_LEVEL
+#define LOG_BACKEND_BIN_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> LOG_LANES_CONFIG_LOG_LEVEL - log_lanes
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef LOG_LANES_CONFIG_LOG_LEVEL
+#define LOG_LANES_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> LOG_LEVELS_CONFIG_LOG_LEVEL - log_levels
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef LOG_LEVELS_CONFIG_LOG_LEVEL
+#define LOG_LEVELS_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> LOG_STRESS_CONFIG_LOG_LEVEL - log_stress
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef LOG_STRESS_CONFIG_LOG_LEVEL
+#define LOG_STRESS_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> MOTION_CONFIG_LOG_LEVEL - motion
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef MOTION_CONFIG_LOG_LEVEL
+#define MOTION_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> PERIODIC_TASK_CONFIG_LOG_LEVEL - periodic_task
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef PERIODIC_TASK_CONFIG_LOG_LEVEL
+#define PERIODIC_TASK_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> PWM_CHANNELS_CONFIG_LOG_LEVEL - pwm_channels
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef PWM_CHANNELS_CONFIG_LOG_LEVEL
+#define PWM_CHANNELS_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> SCOPE_PROFILE_CONFIG_LOG_LEVEL - scope_profile
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef SCOPE_PROFILE_CONFIG_LOG_LEVEL
+#define SCOPE_PROFILE_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> STACK_USAGE_CONFIG_LOG_LEVEL - stack_usage
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef STACK_USAGE_CONFIG_LOG_LEVEL
+#define STACK_USAGE_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> USB_AUDIO_CONFIG_LOG_LEVEL - usb_audio
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef USB_AUDIO_CONFIG_LOG_LEVEL
+#define USB_AUDIO_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> USB_AUX_CONFIG_LOG_LEVEL - usb_aux
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef USB_AUX_CONFIG_LOG_LEVEL
+#define USB_AUX_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> WORK_CONFIG_LOG_LEVEL - work
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef WORK_CONFIG_LOG_LEVEL
+#define WORK_CONFIG_LOG_LEVEL 3
+#endif
+
+// <o> WS2812_CONFIG_LOG_LEVEL - ws2812
+
+// <0=> Off
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef WS2812_CONFIG_LOG_LEVEL
+#define WS2812_CONFIG_LOG_LEVEL 3
+#endif
+
+// <q> LOG_LEVELS_BENCHMARK - Log the cycle cost of compiled-out, filtered and enabled sites
+// <i> Requires LOG_LEVELS_CONFIG_LOG_LEVEL set to Info.
+#ifndef LOG_LEVELS_BENCHMARK
+#define LOG_LEVELS_BENCHMARK 0
+#endif
+
+// </h>
+
+// <e> USB_AUX_ENABLED - Auxiliary CDC ACM port for binary streams
+// <i> Appended to the USB stack of the text log backend, or brings up the
+// <i> stack itself when LOG_BACKEND_BIN_ENABLED leaves that backend out.
+//==========================================================
+#ifndef USB_AUX_ENABLED
+#define USB_AUX_ENABLED 1
+#endif
+// <o> USB_AUX_CDC_ACM_COMM_INTERFACE - CDC ACM COMM Interface number
+// <i> Follows the interfaces of the text log backend, if there is one.
+#ifndef USB_AUX_CDC_ACM_COMM_INTERFACE
+#define USB_AUX_CDC_ACM_COMM_INTERFACE (LOG_BACKEND_BIN_ENABLED ? 0 : 2)
+#endif
+
+// <o> USB_AUX_CDC_ACM_DATA_INTERFACE - CDC ACM Data Interface number
+#ifndef USB_AUX_CDC_ACM_DATA_INTERFACE
+#define USB_AUX_CDC_ACM_DATA_INTERFACE (LOG_BACKEND_BIN_ENABLED ? 1 : 3)
+#endif
+
+// <o> USB_AUX_CDC_ACM_COMM_EPIN - CDC ACM COMM IN endpoint number
+#ifndef USB_AUX_CDC_ACM_COMM_EPIN
+#define USB_AUX_CDC_ACM_COMM_EPIN 4
+#endif
+
+// <o> USB_AUX_CDC_ACM_DATA_EPIN - CDC ACM DATA IN endpoint number
+#ifndef USB_AUX_CDC_ACM_DATA_EPIN
+#define USB_AUX_CDC_ACM_DATA_EPIN 3
+#endif
+
+// <o> USB_AUX_CDC_ACM_DATA_EPOUT - CDC ACM DATA OUT endpoint number
+#ifndef USB_AUX_CDC_ACM_DATA_EPOUT
+#define USB_AUX_CDC_ACM_DATA_EPOUT 3
+#endif
+
+// <o> USB_AUX_TX_BUFFER_SIZE - Size of the TX ring, must be a power of 2
+#ifndef USB_AUX_TX_BUFFER_SIZE
+#define USB_AUX_TX_BUFFER_SIZE 1024
+#endif
+
+// </e>
+
+// <e> LOG_BACKEND_BIN_ENABLED - Tokenized binary log backend on the auxiliary USB port
+// <i> Sends format string addresses and raw arguments, decoded on the host
+// <i> by tools/aux_decode.py. Replaces the text USB log backend, so no entry
+// <i> is formatted on the target and the device enumerates with the
+// <i> auxiliary port only. Requires USB_AUX_ENABLED.
+//==========================================================
+#ifndef LOG_BACKEND_BIN_ENABLED
+#define LOG_BACKEND_BIN_ENABLED 1
+#endif
+// <q> LOG_BACKEND_BIN_PACKED - Varint-packed records with delta timestamps
+// <i> Sends USB_AUX_FRAME_LOG_PACKED instead of the fixed-size USB_AUX_FRAME_LOG.
+#ifndef LOG_BACKEND_BIN_PACKED
+#define LOG_BACKEND_BIN_PACKED 1
+#endif
+
+// <o> LOG_BACKEND_BIN_TIMESTAMP_SHIFT - Resolution of packed timestamps
+// <i> Timestamps are sent in units of 2^shift ticks of the 16 MHz clock,
+// <i> 4 gives 1 us.
+#ifndef LOG_BACKEND_BIN_TIMESTAMP_SHIFT
+#define LOG_BACKEND_BIN_TIMESTAMP_SHIFT 4
+#endif
+
+// <o> LOG_BACKEND_BIN_SYNC_INTERVAL - Packed records between absolute timestamps
+// <i> Lets a host that attaches mid-stream, or missed a frame, resynchronize.
+#ifndef LOG_BACKEND_BIN_SYNC_INTERVAL
+#define LOG_BACKEND_BIN_SYNC_INTERVAL 64
+#endif
+
+// <q> LOG_BACKEND_BIN_BENCHMARK - Compare the binary and text paths
+// <i> Runs with the binary backend alone, as shipped. Every entry is also
+// <i> formatted the way the text backend would, into a sink that only counts
+// <i> bytes, and logs bytes and CPU cycles of both paths, and the bytes per
+// <i> record of the fixed and packed binary layouts.
+#ifndef LOG_BACKEND_BIN_BENCHMARK
+#define LOG_BACKEND_BIN_BENCHMARK 0
+#endif
+
+// <o> LOG_BACKEND_BIN_BENCHMARK_MESSAGES - Number of messages per benchmark report
+#ifndef LOG_BACKEND_BIN_BENCHMARK_MESSAGES
+#define LOG_BACKEND_BIN_BENCHMARK_MESSAGES 64
+#endif
+
+// </e>
+
+// <h> log_lanes - Per-severity log lanes
+//==========================================================
+// <o> LOG_LANES_ERROR_CAPACITY - Number of entries in the error lane
+#ifndef LOG_LANES_ERROR_CAPACITY
+#define LOG_LANES_ERROR_CAPACITY 8
+#endif
+
+// <o> LOG_LANES_WARNING_CAPACITY - Number of entries in the warning lane
+#ifndef LOG_LANES_WARNING_CAPACITY
+#define LOG_LANES_WARNING_CAPACITY 8
+#endif
+
+// <o> LOG_LANES_INFO_CAPACITY - Number of entries in the info lane
+#ifndef LOG_LANES_INFO_CAPACITY
+#define LOG_LANES_INFO_CAPACITY 16
+#endif
+
+// <o> LOG_LANES_DEBUG_CAPACITY - Number of entries in the debug lane
+#ifndef LOG_LANES_DEBUG_CAPACITY
+#define LOG_LANES_DEBUG_CAPACITY 16
+#endif
+
+// <o> LOG_LANES_BATCH - Entries forwarded per main loop pass
+#ifndef LOG_LANES_BATCH
+#define LOG_LANES_BATCH 4
+#endif
+
+// </h>
+
+// <e> CRASH_LOG_ENABLED - Log ring in retained RAM, replayed after reset
+// <i> Records log entries into a .noinit ring guarded by a magic word and a
+// <i> CRC32, and replays the records found there after the next boot.
+//==========================================================
+#ifndef CRASH_LOG_ENABLED
+#define CRASH_LOG_ENABLED 1
+#endif
+// <o> CRASH_LOG_SIZE - Size of the ring in bytes, must be a power of 2
+#ifndef CRASH_LOG_SIZE
+#define CRASH_LOG_SIZE 1024
+#endif
+
+// <o> CRASH_LOG_SEVERITY - Most verbose severity recorded
+
+// <1=> Error
+// <2=> Warning
+// <3=> Info
+// <4=> Debug
+
+#ifndef CRASH_LOG_SEVERITY
+#define CRASH_LOG_SEVERITY 3
+#endif
+
+// <o> CRASH_LOG_BATCH - Records replayed per main loop pass
+#ifndef CRASH_LOG_BATCH
+#define CRASH_LOG_BATCH 4
+#endif
+
+// </e>
+
+// <e> LOG_STRESS_ENABLED - Log throughput stress mode
+// <i> Sweeps message rates and argument counts and reports delivered and
+// <i> dropped messages and the saturation point of each configuration.
+// <i> Measures the binary USB backend, requires LOG_BACKEND_BIN_ENABLED.
+//==========================================================
+#ifndef LOG_STRESS_ENABLED
+#define LOG_STRESS_ENABLED 0
+#endif
+// <o> LOG_STRESS_STEP_MS - Duration of each rate step
+#ifndef LOG_STRESS_STEP_MS
+#define LOG_STRESS_STEP_MS 2000
+#endif
+
+// <o> LOG_STRESS_SETTLE_MS - Pause after each step to let the buffer drain
+// <i> Each step also waits until the auxiliary port has sent everything.
+#ifndef LOG_STRESS_SETTLE_MS
+#define LOG_STRESS_SETTLE_MS 500
+#endif
+
+// </e>
+
+// <h> periodic_task - Periodic task framework
+//==========================================================
+// <o> PERIODIC_TASK_REPORT_INTERVAL - Number of runs between jitter reports
+// <i> Statistics are logged every PERIODIC_TASK_REPORT_INTERVAL runs of each task.
+// <i> 0 disables periodic reports.
+#ifndef PERIODIC_TASK_REPORT_INTERVAL
+#define PERIODIC_TASK_REPORT_INTERVAL 40
+#endif
+
+// </h>
+
+// <h> idle - Tickless idle
+//==========================================================
+// <o> IDLE_REPORT_PERIOD_MS - Period of sleep time reports
+// <i> Logs the share of time spent asleep. 0 disables the reports.
+#ifndef IDLE_REPORT_PERIOD_MS
+#define IDLE_REPORT_PERIOD_MS 10000
+#endif
+
+// </h>
+
+// <h> metrics - Metrics registry
+//==========================================================
+// <o> METRICS_PERIOD_MS - Period of the snapshots sent over the auxiliary USB port
+// <i> 0 disables the snapshots, the metrics are still kept.
+#ifndef METRICS_PERIOD_MS
+#define METRICS_PERIOD_MS 1000
+#endif
+
+// <o> METRICS_FRAME_VALUES - Maximum number of values per snapshot frame
+#ifndef METRICS_FRAME_VALUES
+#define METRICS_FRAME_VALUES 32
+#endif
+
+// </h>
+
+// <h> work - Main loop pending-work signalling
+//==========================================================
+// <o> WORK_REPORT_PERIOD_MS - Period of productive/wasted loop pass reports
+// <i> 0 disables the reports.
+#ifndef WORK_REPORT_PERIOD_MS
+#define WORK_REPORT_PERIOD_MS 10000
+#endif
+
+// </h>
+
+// <e> PROFILER_ENABLED - Sampling PC profiler on TIMER2
+// <i> Streams PC histograms over the auxiliary USB port, rendered by
+// <i> tools/aux_profile.py. Requires USB_AUX_ENABLED.
+//==========================================================
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 0
+#endif
+// <o> PROFILER_RATE_HZ - Sampling rate
+#ifndef PROFILER_RATE_HZ
+#define PROFILER_RATE_HZ 1000
+#endif
+
+// <o> PROFILER_PC_SHIFT - log2 of the bytes covered by one histogram bucket
+#ifndef PROFILER_PC_SHIFT
+#define PROFILER_PC_SHIFT 4
+#endif
+
+// <o> PROFILER_SLOTS - Number of histogram buckets, must be a power of 2
+#ifndef PROFILER_SLOTS
+#define PROFILER_SLOTS 128
+#endif
+
+// <o> PROFILER_REPORT_MS - Period of the histogram reports
+#ifndef PROFILER_REPORT_MS
+#define PROFILER_REPORT_MS 1000
+#endif
+
+// </e>
+
+// <e> SCOPE_PROFILE_ENABLED - Named-scope cycle profiler
+// <i> Accumulates DWT cycles, calls and the longest call of every
+// <i> SCOPE_PROFILE_BEGIN()/SCOPE_PROFILE_END() pair and logs the table.
+//==========================================================
+#ifndef SCOPE_PROFILE_ENABLED
+#define SCOPE_PROFILE_ENABLED 0
+#endif
+// <o> SCOPE_PROFILE_REPORT_PERIOD_MS - Period of scope table reports
+// <i> 0 disables the reports, scope_profile_log() still dumps the table.
+#ifndef SCOPE_PROFILE_REPORT_PERIOD_MS
+#define SCOPE_PROFILE_REPORT_PERIOD_MS 5000
+#endif
+
+// </e>
+
+// <e> STACK_USAGE_ENABLED - Main stack high-water mark and per-exception depths
+// <i> Paints the stack at boot and logs the deepest use since. With
+// <i> PROFILER_ENABLED the PC samples also record per-exception depths.
+//==========================================================
+#ifndef STACK_USAGE_ENABLED
+#define STACK_USAGE_ENABLED 1
+#endif
+// <o> STACK_USAGE_REPORT_PERIOD_MS - Period of stack usage reports
+// <i> 0 disables the reports, the stack_high_water metric is then only set at init.
+#ifndef STACK_USAGE_REPORT_PERIOD_MS
+#define STACK_USAGE_REPORT_PERIOD_MS 10000
+#endif
+
+// </e>
+
+// <h> dsp - Fixed-point kernels
+//==========================================================
+// <q> DSP_BENCHMARK - Check the kernels against their references and log their cycles at boot
+#ifndef DSP_BENCHMARK
+#define DSP_BENCHMARK 0
+#endif
+
+// </h>
+
+// <e> WAVEFORM_ENABLED - Waveform synthesis on PWM0
+// <i> Replaces the fixed duty table on pwm_pin with a waveform streamed
+// <i> through two sequence buffers refilled from the PWM0 interrupt.
+//==========================================================
+#ifndef WAVEFORM_ENABLED
+#define WAVEFORM_ENABLED 0
+#endif
+// <o> WAVEFORM_SAMPLE_RATE_HZ - Sample rate
+// <i> Rounded to the PWM frequency divided by a whole number.
+#ifndef WAVEFORM_SAMPLE_RATE_HZ
+#define WAVEFORM_SAMPLE_RATE_HZ 16000
+#endif
+
+// <o> WAVEFORM_BUFFER_LENGTH - Samples per sequence buffer
+// <i> Each buffer must be refilled within its own playback time.
+#ifndef WAVEFORM_BUFFER_LENGTH
+#define WAVEFORM_BUFFER_LENGTH 64
+#endif
+
+// </e>
+
+// <e> USB_AUDIO_ENABLED - PCM audio from the auxiliary USB port on PWM0
+// <i> Plays signed 16-bit mono samples written by tools/aux_play.py on
+// <i> pwm_pin. Requires USB_AUX_ENABLED, excludes WAVEFORM_ENABLED.
+//==========================================================
+#ifndef USB_AUDIO_ENABLED
+#define USB_AUDIO_ENABLED 0
+#endif
+// <o> USB_AUDIO_INPUT_RATE_HZ - Sample rate of the host stream
+#ifndef USB_AUDIO_INPUT_RATE_HZ
+#define USB_AUDIO_INPUT_RATE_HZ 16000
+#endif
+
+// <o> USB_AUDIO_OUTPUT_RATE_HZ - PWM sample rate
+// <i> Rounded to the PWM frequency divided by a whole number.
+#ifndef USB_AUDIO_OUTPUT_RATE_HZ
+#define USB_AUDIO_OUTPUT_RATE_HZ 32000
+#endif
+
+// <o> USB_AUDIO_BUFFER_SIZE - Size of the jitter ring in bytes, must be a power of 2
+#ifndef USB_AUDIO_BUFFER_SIZE
+#define USB_AUDIO_BUFFER_SIZE 8192
+#endif
+
+// <o> USB_AUDIO_PWM_BUFFER_LENGTH - Samples per PWM sequence buffer
+#ifndef USB_AUDIO_PWM_BUFFER_LENGTH
+#define USB_AUDIO_PWM_BUFFER_LENGTH 128
+#endif
+
+// </e>
+
+// <e> PWM_CHANNELS_ENABLED - Individual-load PWM dimming channels
+// <i> Four channels per PWM instance, updated at period boundaries.
+//==========================================================
+#ifndef PWM_CHANNELS_ENABLED
+#define PWM_CHANNELS_ENABLED 0
+#endif
+// <o> PWM_CHANNELS_INSTANCES - Bit mask of the PWM instances to use
+// <i> Bit n selects PWMn. The selected instances, lowest first, drive the
+// <i> dimming_pins of main.c four at a time: with 0x0e, PWM1 drives P1.01 to
+// <i> P1.04, PWM2 P1.05 to P1.08 and PWM3 is left unused. Selecting PWM0
+// <i> gives it to the first four dimming pins; pwm_pin is then not driven.
+#ifndef PWM_CHANNELS_INSTANCES
+#define PWM_CHANNELS_INSTANCES 0x0e
+#endif
+
+// <o> PWM_CHANNELS_BASE_CLOCK - Base clock
+
+// <0=> 16 MHz
+// <1=> 8 MHz
+// <2=> 4 MHz
+// <3=> 2 MHz
+// <4=> 1 MHz
+// <5=> 500 kHz
+// <6=> 250 kHz
+// <7=> 125 kHz
+
+#ifndef PWM_CHANNELS_BASE_CLOCK
+#define PWM_CHANNELS_BASE_CLOCK 4
+#endif
+
+// <o> PWM_CHANNELS_TOP_VALUE - Top value, the full-scale duty cycle
+#ifndef PWM_CHANNELS_TOP_VALUE
+#define PWM_CHANNELS_TOP_VALUE 1000
+#endif
+
+// </e>
+
+// <e> WS2812_ENABLED - WS2812 LED strip on PWM0
+// <i> Drives the strip data line from pwm_pin at 800 kHz. Excludes
+// <i> WAVEFORM_ENABLED and USB_AUDIO_ENABLED.
+//==========================================================
+#ifndef WS2812_ENABLED
+#define WS2812_ENABLED 0
+#endif
+// <o> WS2812_LEDS - Number of LEDs on the strip
+#ifndef WS2812_LEDS
+#define WS2812_LEDS 300
+#endif
+
+// <o> WS2812_CHUNK_LEDS - LEDs encoded per PWM sequence buffer
+// <i> Each buffer takes 48 bytes and 30 us of playback per LED.
+#ifndef WS2812_CHUNK_LEDS
+#define WS2812_CHUNK_LEDS 8
+#endif
+
+// <o> WS2812_RESET_US - Low time that latches a frame
+#ifndef WS2812_RESET_US
+#define WS2812_RESET_US 300
+#endif
+
+// </e>
+
+// <e> DITHER_ENABLED - 16-bit duty cycle on PWM0 by delta-sigma dithering
+// <i> Keeps the PWM0 carrier and spreads the fractional part of the duty
+// <i> cycle over consecutive periods. Excludes the other PWM0 users.
+//==========================================================
+#ifndef DITHER_ENABLED
+#define DITHER_ENABLED 0
+#endif
+// <o> DITHER_BUFFER_LENGTH - PWM periods per sequence buffer
+// <i> Each buffer must be refilled within its own playback time.
+#ifndef DITHER_BUFFER_LENGTH
+#define DITHER_BUFFER_LENGTH 256
+#endif
+
+// </e>
+
+// <e> MOTION_ENABLED - Motion profiles on the PWM0 channels
+// <i> One axis per channel, moves planned into PWM tables. Excludes
+// <i> WAVEFORM_ENABLED, USB_AUDIO_ENABLED and WS2812_ENABLED.
+//==========================================================
+#ifndef MOTION_ENABLED
+#define MOTION_ENABLED 0
+#endif
+// <o> MOTION_STEP_US - Time between position steps
+#ifndef MOTION_STEP_US
+#define MOTION_STEP_US 1000
+#endif
+
+// <o> MOTION_TABLE_STEPS - Steps per move table
+// <i> Longer moves get longer steps. Each step takes 8 bytes, twice.
+#ifndef MOTION_TABLE_STEPS
+#define MOTION_TABLE_STEPS 256
+#endif
+
+// </e>
+
+// <e> CONTROL_ENABLED - Control loop sampled in step with PWM0
+// <i> PWM0 period ends trigger the SAADC through PPI, the result sets the
+// <i> next duty cycle on pwm_pin. Uses the hires clock capture channel 5.
+// <i> Excludes the other PWM0 users.
+//==========================================================
+#ifndef CONTROL_ENABLED
+#define CONTROL_ENABLED 0
+#endif
+// <o> CONTROL_AIN - Analog input to sample, AIN0 to AIN7
+#ifndef CONTROL_AIN
+#define CONTROL_AIN 0
+#endif
+
+// <o> CONTROL_REPORT_PERIOD_MS - Period of latency reports
+#ifndef CONTROL_REPORT_PERIOD_MS
+#define CONTROL_REPORT_PERIOD_MS 5000
+#endif
+
+// </e>
+
+// <e> DISPLAY_MUX_ENABLED - 7-segment digits multiplexed by PWM1 to PWM3
+// <i> Replaces the MAX7219 on SPIM0. Segments and digit commons are driven
+// <i> directly, scanned in hardware one digit per PWM step with a brightness
+// <i> per digit. Needs PWM1 to PWM3 left out of PWM_CHANNELS_INSTANCES.
+//==========================================================
+#ifndef DISPLAY_MUX_ENABLED
+#define DISPLAY_MUX_ENABLED 0
+#endif
+// <o> DISPLAY_MUX_DIGITS - Number of digits <1-5>
+// <i> Each digit is lit for 1 ms of every scan.
+#ifndef DISPLAY_MUX_DIGITS
+#define DISPLAY_MUX_DIGITS 4
+#endif
+
+// </e>
+
+// <e> IRQ_LATENCY_ENABLED - Interrupt latency harness
+// <i> Timestamps SPIM0 END, PWM0 SEQEND0 and RTC1 COMPARE0 in hardware through
+// <i> PPI and measures the time until the corresponding handler is entered.
+// <i> Enabling it also makes PWM0 interrupt at the end of every sequence,
+// <i> which loads the other sources.
+//==========================================================
+#ifndef IRQ_LATENCY_ENABLED
+#define IRQ_LATENCY_ENABLED 0
+#endif
+// <o> IRQ_LATENCY_REPORT_PERIOD_MS - Period of latency reports
+#ifndef IRQ_LATENCY_REPORT_PERIOD_MS
+#define IRQ_LATENCY_REPORT_PERIOD_MS 5000
+#endif
+
+// </e>
+
 #endif
@@ -0,0 +1,42 @@
+#ifndef IRQ_PRIORITIES_H
+#define IRQ_PRIORITIES_H
+
+/* Application interrupt priority map.
+ *
+ * 0 is the highest priority, 7 the lowest. Every interrupt the application
+ * enables takes its priority from here; app_config.h routes these values into
+ * both the nrfx and the legacy driver configuration, so this file is the only
+ * place to tune them. Use the IRQ_LATENCY harness to check the effect of a
+ * change. */
+
+/* the sampling profiler has to interrupt everything it measures */
+#define IRQ_PRIO_PROFILER       1
+
+/* PWM sequence refills have the tightest deadline: one sequence period */
+#define IRQ_PRIO_PWM0           2
+
+/* the control loop has to set the next duty cycle within one PWM period;
+ * it owns PWM0 when enabled, so the two never compete */
+#define IRQ_PRIO_CONTROL        2
+
+/* SPIM0 feeds the display one register at a time from its FIFO */
+#define IRQ_PRIO_SPIM0          3
+
+/* dimming channel updates only need to land within one PWM period */
+#define IRQ_PRIO_PWM_CHANNELS   4
+
+/* app_timer (RTC1 and its SWI) */
+#define IRQ_PRIO_APP_TIMER      5
+
+/* USB and the shared POWER_CLOCK interrupt only move log data */
+#define IRQ_PRIO_USBD           6
+#define IRQ_PRIO_POWER_CLOCK    6
+
+/* the display scan runs without a handler, the priority only has to stay
+ * out of the way should an event ever be enabled */
+#define IRQ_PRIO_DISPLAY_MUX    7
+
+/* RTC2 compare only wakes the core from tickless idle */
+#define IRQ_PRIO_IDLE_RTC       7
+
+#endif
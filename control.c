@@ -0,0 +1,244 @@
+#include <stdint.h>
+
+#include "control.h"
+
+#if CONTROL_ENABLED
+
+#include "hires_clock.h"
+#include "irq_priorities.h"
+#include "metrics.h"
+
+#include "app_timer.h"
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "nrfx.h"
+#include "nrfx_ppi.h"
+#include "nrf_pwm.h"
+#include "nrf_saadc.h"
+
+#define NRF_LOG_MODULE_NAME control
+#define NRF_LOG_LEVEL CONTROL_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+/* duty values with bit 15 set, as in the fixed duty table */
+enum { control_polarity = 0x8000 };
+
+/* irq_latency captures on channels 1 to 3 */
+enum { control_capture_channel = 5 };
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} control_stats_t;
+
+static control_compute_t control_compute;
+static uint16_t control_top_value;
+static uint32_t control_period_ticks;
+
+static nrf_saadc_value_t control_sample;    /* written by EasyDMA */
+static uint16_t control_duty;               /* read by EasyDMA */
+
+static nrf_pwm_sequence_t control_sequence = {
+    .values.p_common = &control_duty,
+    .length = 1,
+    .repeats = 0,
+    .end_delay = 0
+};
+
+/* period end to handler entry, and to the new duty cycle */
+static control_stats_t control_entry_stats;
+static control_stats_t control_loop_stats;
+
+METRIC_DEF(control_overruns, METRIC_COUNTER);
+
+APP_TIMER_DEF(control_report_timer);
+
+static void control_stats_add(control_stats_t *p_stats, uint32_t ticks)
+{
+    if (p_stats->count == 0 || ticks < p_stats->min)
+    {
+        p_stats->min = ticks;
+    }
+
+    if (ticks > p_stats->max)
+    {
+        p_stats->max = ticks;
+    }
+
+    p_stats->sum += ticks;
+    p_stats->count++;
+}
+
+void SAADC_IRQHandler(void)
+{
+    uint32_t period_end = hires_clock_capture_read(control_capture_channel);
+    uint32_t loop;
+
+    control_stats_add(&control_entry_stats, hires_clock_now() - period_end);
+
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_END);
+
+    control_duty = MIN(control_compute(control_sample), control_top_value)
+                   | control_polarity;
+
+    loop = hires_clock_now() - period_end;
+
+    control_stats_add(&control_loop_stats, loop);
+
+    if (loop > control_period_ticks)
+    {
+        METRIC_INC(control_overruns);
+    }
+}
+
+static void control_stats_log(char const *p_name, control_stats_t const *p_stats)
+{
+    control_stats_t stats;
+
+    CRITICAL_REGION_ENTER();
+    stats = *p_stats;
+    CRITICAL_REGION_EXIT();
+
+    if (stats.count == 0)
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("%s: %u loops, latency min/max/mean %u/%u/%u ns",
+                 p_name,
+                 stats.count,
+                 HIRES_CLOCK_TICKS_TO_NS(stats.min),
+                 HIRES_CLOCK_TICKS_TO_NS(stats.max),
+                 HIRES_CLOCK_TICKS_TO_NS(stats.sum / stats.count));
+}
+
+void control_log(void)
+{
+    control_stats_log("irq entry", &control_entry_stats);
+    control_stats_log("duty update", &control_loop_stats);
+}
+
+static void control_report(void *ctx)
+{
+    control_log();
+}
+
+static void control_saadc_init(void)
+{
+    nrf_saadc_channel_config_t channel = {
+        .resistor_p = NRF_SAADC_RESISTOR_DISABLED,
+        .resistor_n = NRF_SAADC_RESISTOR_DISABLED,
+        .gain = NRF_SAADC_GAIN1_6,
+        .reference = NRF_SAADC_REFERENCE_INTERNAL,
+        .acq_time = NRF_SAADC_ACQTIME_3US,
+        .mode = NRF_SAADC_MODE_SINGLE_ENDED,
+        .burst = NRF_SAADC_BURST_DISABLED
+    };
+
+    nrf_saadc_resolution_set(NRF_SAADC, NRF_SAADC_RESOLUTION_12BIT);
+    nrf_saadc_oversample_set(NRF_SAADC, NRF_SAADC_OVERSAMPLE_DISABLED);
+    nrf_saadc_channel_init(NRF_SAADC, 0, &channel);
+    nrf_saadc_channel_input_set(NRF_SAADC,
+                                0,
+                                (nrf_saadc_input_t)(NRF_SAADC_INPUT_AIN0 + CONTROL_AIN),
+                                NRF_SAADC_INPUT_DISABLED);
+
+    nrf_saadc_int_disable(NRF_SAADC, NRF_SAADC_INT_ALL);
+    nrf_saadc_enable(NRF_SAADC);
+
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_CALIBRATEDONE);
+    nrf_saadc_task_trigger(NRF_SAADC, NRF_SAADC_TASK_CALIBRATEOFFSET);
+
+    while (!nrf_saadc_event_check(NRF_SAADC, NRF_SAADC_EVENT_CALIBRATEDONE))
+    {
+    }
+
+    nrf_saadc_buffer_init(NRF_SAADC, &control_sample, 1);
+
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_STARTED);
+    nrf_saadc_task_trigger(NRF_SAADC, NRF_SAADC_TASK_START);
+
+    while (!nrf_saadc_event_check(NRF_SAADC, NRF_SAADC_EVENT_STARTED))
+    {
+    }
+
+    nrf_saadc_event_clear(NRF_SAADC, NRF_SAADC_EVENT_END);
+    nrf_saadc_int_enable(NRF_SAADC, NRF_SAADC_INT_END);
+
+    NRFX_IRQ_PRIORITY_SET(SAADC_IRQn, IRQ_PRIO_CONTROL);
+    NRFX_IRQ_ENABLE(SAADC_IRQn);
+}
+
+static nrfx_err_t control_route(uint32_t event_address, uint32_t task_address, uint32_t fork_address)
+{
+    nrf_ppi_channel_t channel;
+    nrfx_err_t err;
+
+    err = nrfx_ppi_channel_alloc(&channel);
+
+    if (err != NRFX_SUCCESS)
+    {
+        return err;
+    }
+
+    nrfx_ppi_channel_assign(channel, event_address, task_address);
+
+    if (fork_address != 0)
+    {
+        nrfx_ppi_channel_fork_assign(channel, fork_address);
+    }
+
+    return nrfx_ppi_channel_enable(channel);
+}
+
+void control_start(nrfx_pwm_t const *p_pwm,
+                   uint16_t top_value,
+                   uint32_t pwm_frequency_hz,
+                   control_compute_t compute)
+{
+    nrfx_err_t err;
+
+    control_compute = compute;
+    control_top_value = top_value;
+    control_period_ticks = hires_clock_freq_hz / pwm_frequency_hz;
+
+    control_duty = control_polarity;
+
+    hires_clock_init();
+    control_saadc_init();
+
+    err = control_route((uint32_t)nrf_saadc_event_address_get(NRF_SAADC, NRF_SAADC_EVENT_END),
+                        (uint32_t)nrf_saadc_task_address_get(NRF_SAADC, NRF_SAADC_TASK_START),
+                        0);
+
+    if (err == NRFX_SUCCESS)
+    {
+        err = control_route(nrf_pwm_event_address_get(p_pwm->p_registers, NRF_PWM_EVENT_PWMPERIODEND),
+                            (uint32_t)nrf_saadc_task_address_get(NRF_SAADC, NRF_SAADC_TASK_SAMPLE),
+                            hires_clock_capture_task_address(control_capture_channel));
+    }
+
+    if (err != NRFX_SUCCESS)
+    {
+        NRF_LOG_ERROR("no PPI channels for the control loop");
+        return;
+    }
+
+    app_timer_create(&control_report_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     control_report);
+    app_timer_start(control_report_timer,
+                    APP_TIMER_TICKS(CONTROL_REPORT_PERIOD_MS),
+                    NULL);
+
+    /* the one-value sequence is loaded again every period */
+    nrfx_pwm_simple_playback(p_pwm,
+                             &control_sequence,
+                             1,
+                             NRFX_PWM_FLAG_LOOP | NRFX_PWM_FLAG_NO_EVT_FINISHED);
+}
+
+#endif
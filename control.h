@@ -0,0 +1,40 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdint.h>
+
+#include "nrfx_pwm.h"
+#include "sdk_config.h"
+
+/* Closed control loop sampled in step with PWM.
+ *
+ * The PWMPERIODEND event of the PWM triggers the SAADC SAMPLE task through
+ * PPI, so the sample is taken at the same point of every period without
+ * any software in the path. The result goes into a one-sample EasyDMA
+ * buffer, and SAADC END starts the buffer again through a second PPI
+ * channel. The END interrupt runs the compute callback, which returns the
+ * duty cycle the PWM loads at its next sequence start.
+ *
+ * The same PPI channel captures the period end on the hires clock, so the
+ * time to the interrupt and to the new duty cycle are measured from the
+ * hardware event. Both are logged every CONTROL_REPORT_PERIOD_MS. Loops
+ * that take longer than a PWM period count in the control_overruns
+ * metric. */
+
+#if CONTROL_ENABLED
+
+/* gets the sample of the period that just ended, returns the duty cycle
+ * from 0 to the top value; runs in the SAADC interrupt */
+typedef uint16_t (*control_compute_t)(int16_t sample);
+
+/* p_pwm must be initialized with common load and automatic steps */
+void control_start(nrfx_pwm_t const *p_pwm,
+                   uint16_t top_value,
+                   uint32_t pwm_frequency_hz,
+                   control_compute_t compute);
+
+void control_log(void);
+
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef CORO_H
+#define CORO_H
+
+#include <stdint.h>
+
+#include "app_timer.h"
+
+/* Stackless coroutines built on switch-based continuations.
+ *
+ * A coroutine is a plain function taking a coro_t pointer and returning
+ * coro_state_t. Its state is the line it is suspended on plus the start and
+ * length of a pending CORO_DELAY(), 12 bytes in all, so local variables do
+ * not survive a suspension: keep them static or in a caller-provided
+ * context. A coroutine body must not contain switch statements of its own
+ * around a suspension point.
+ *
+ *     static coro_state_t thread(coro_t *c)
+ *     {
+ *         CORO_BEGIN(c);
+ *         start_transfer();
+ *         CORO_AWAIT(c, transfer_done);
+ *         CORO_DELAY(c, APP_TIMER_TICKS(10));
+ *         CORO_END(c);
+ *     }
+ *
+ * The owner polls the function whenever something it may be waiting for has
+ * happened; a finished coroutine returns CORO_DONE immediately. */
+
+typedef enum {
+    CORO_WAITING,
+    CORO_DONE
+} coro_state_t;
+
+typedef struct {
+    uint16_t lc;
+    uint32_t timestamp;
+    uint32_t delay;             /* non-zero while suspended in CORO_DELAY() */
+} coro_t;
+
+enum { coro_lc_done = UINT16_MAX };
+
+#define CORO_NO_DEADLINE UINT32_MAX
+
+#define CORO_INIT(c) ((c)->lc = 0, (c)->delay = 0)
+
+#define CORO_IS_DONE(c) ((c)->lc == coro_lc_done)
+
+#define CORO_BEGIN(c) switch ((c)->lc) { case 0:
+
+#define CORO_END(c)                                                          \
+    }                                                                        \
+    (c)->lc = coro_lc_done;                                                  \
+    return CORO_DONE
+
+#define CORO_YIELD(c)                                                        \
+    do {                                                                     \
+        (c)->lc = __LINE__;                                                  \
+        return CORO_WAITING;                                                 \
+        case __LINE__:;                                                      \
+    } while (0)
+
+#define CORO_AWAIT(c, cond)                                                  \
+    do {                                                                     \
+        (c)->lc = __LINE__;                                                  \
+        case __LINE__:                                                       \
+        if (!(cond))                                                         \
+        {                                                                    \
+            return CORO_WAITING;                                             \
+        }                                                                    \
+    } while (0)
+
+#define CORO_DELAY(c, ticks)                                                 \
+    do {                                                                     \
+        (c)->timestamp = app_timer_cnt_get();                                \
+        (c)->delay = (ticks);                                                \
+        CORO_AWAIT(c, app_timer_cnt_diff_compute(app_timer_cnt_get(),        \
+                                                 (c)->timestamp) >= (c)->delay);\
+        (c)->delay = 0;                                                      \
+    } while (0)
+
+/* Ticks until a coroutine suspended in CORO_DELAY() wants to run again,
+ * CORO_NO_DEADLINE when it is waiting for anything else or has finished. */
+static inline uint32_t coro_deadline(coro_t const *c)
+{
+    uint32_t elapsed;
+
+    if (CORO_IS_DONE(c) || c->delay == 0)
+    {
+        return CORO_NO_DEADLINE;
+    }
+
+    elapsed = app_timer_cnt_diff_compute(app_timer_cnt_get(), c->timestamp);
+
+    return elapsed >= c->delay ? 0 : c->delay - elapsed;
+}
+
+#endif
@@ -0,0 +1,441 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "crash_log.h"
+
+#if CRASH_LOG_ENABLED
+
+#include "log_lanes.h"
+#include "work.h"
+
+#if LOG_BACKEND_BIN_ENABLED
+#include "usb_aux.h"
+#elif LOG_BACKEND_USB_ENABLED
+#include "app_usbd.h"
+#include "app_usbd_cdc_acm.h"
+#endif
+
+#define NRF_LOG_MODULE_NAME crash_log
+#define NRF_LOG_LEVEL CRASH_LOG_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#include "nrf_log_backend_interface.h"
+#include "nrf_log_ctrl.h"
+#include "nrf_log_internal.h"
+#include "nrf_memobj.h"
+
+#include "app_util.h"
+#include "crc32.h"
+#include "hardfault.h"
+#include "nrf_power.h"
+
+enum { crash_log_magic = 0x474f4c43 };   /* "CLOG" */
+
+enum { crash_log_words = CRASH_LOG_SIZE / sizeof(uint32_t) };
+enum { crash_log_hexdump_max = 32 };
+
+STATIC_ASSERT((crash_log_words & (crash_log_words - 1)) == 0);
+
+typedef struct {
+    uint32_t magic;
+    uint32_t head;      /* free-running word index of the next record */
+    uint32_t tail;      /* free-running word index of the oldest record */
+    uint32_t crc;       /* of the fields above */
+    uint32_t data[crash_log_words];
+} crash_log_ram_t;
+
+typedef struct {
+    uint8_t words;      /* record length, header included */
+    uint8_t type;       /* HEADER_TYPE_STD or HEADER_TYPE_HEXDUMP */
+    uint8_t severity;
+    uint8_t count;      /* number of arguments or hexdump bytes */
+    uint16_t module_id;
+    uint16_t reserved;
+    union {
+        uint32_t args[1 + NRF_LOG_MAX_NUM_OF_ARGS];   /* format address first */
+        uint8_t data[crash_log_hexdump_max];
+    } payload;
+} crash_log_record_t;
+
+enum { crash_log_record_hdr_words = offsetof(crash_log_record_t, payload) / sizeof(uint32_t) };
+enum { crash_log_record_max_words = sizeof(crash_log_record_t) / sizeof(uint32_t) };
+
+typedef union {
+    crash_log_record_t record;
+    uint32_t words[crash_log_record_max_words];
+} crash_log_buffer_t;
+
+static crash_log_ram_t crash_log_ram __attribute__((section(".noinit")));
+
+static uint32_t crash_log_reset_reason;
+
+/* records below this index were written before the reset */
+static uint32_t crash_log_boundary;
+static uint32_t crash_log_old_records;
+
+static bool crash_log_draining;
+static bool crash_log_announced;
+static bool crash_log_replaying;
+
+static uint32_t crash_log_crc(crash_log_ram_t const *p_ram)
+{
+    return crc32_compute((uint8_t const *)p_ram, offsetof(crash_log_ram_t, crc), NULL);
+}
+
+static void crash_log_seal(crash_log_ram_t *p_ram)
+{
+    p_ram->crc = crash_log_crc(p_ram);
+}
+
+static uint32_t crash_log_record_words(crash_log_ram_t const *p_ram, uint32_t index)
+{
+    /* the length is the lowest byte of the first word */
+    return p_ram->data[index & (crash_log_words - 1)] & 0xff;
+}
+
+static bool crash_log_is_valid(crash_log_ram_t const *p_ram, uint32_t *p_records)
+{
+    uint32_t index;
+    uint32_t words;
+
+    if (p_ram->magic != crash_log_magic || p_ram->crc != crash_log_crc(p_ram))
+    {
+        return false;
+    }
+
+    if (p_ram->head - p_ram->tail > crash_log_words)
+    {
+        return false;
+    }
+
+    *p_records = 0;
+
+    for (index = p_ram->tail; index != p_ram->head; index += words)
+    {
+        words = crash_log_record_words(p_ram, index);
+
+        if (words < crash_log_record_hdr_words
+            || words > crash_log_record_max_words
+            || words > p_ram->head - index)
+        {
+            return false;
+        }
+
+        (*p_records)++;
+    }
+
+    return true;
+}
+
+static void crash_log_write(crash_log_ram_t *p_ram, uint32_t const *p_words, uint32_t words)
+{
+    uint32_t i;
+
+    if (p_ram->head - p_ram->tail + words > crash_log_words)
+    {
+        do
+        {
+            p_ram->tail += crash_log_record_words(p_ram, p_ram->tail);
+        } while (p_ram->head - p_ram->tail + words > crash_log_words);
+
+        /* the header must never describe records that are being overwritten */
+        crash_log_seal(p_ram);
+    }
+
+    for (i = 0; i < words; i++)
+    {
+        p_ram->data[(p_ram->head + i) & (crash_log_words - 1)] = p_words[i];
+    }
+
+    p_ram->head += words;
+    crash_log_seal(p_ram);
+}
+
+static void crash_log_read(crash_log_ram_t const *p_ram, uint32_t index, crash_log_buffer_t *p_buf)
+{
+    uint32_t words = crash_log_record_words(p_ram, index);
+    uint32_t i;
+
+    for (i = 0; i < words; i++)
+    {
+        p_buf->words[i] = p_ram->data[(index + i) & (crash_log_words - 1)];
+    }
+}
+
+static void crash_log_put(nrf_log_backend_t const *p_backend,
+                          nrf_log_entry_t *p_msg)
+{
+    crash_log_buffer_t buf;
+    crash_log_record_t *p_record = &buf.record;
+    nrf_log_header_t header;
+    uint32_t length;
+
+    if (crash_log_replaying)
+    {
+        return;
+    }
+
+    nrf_memobj_get(p_msg);
+    nrf_memobj_read(p_msg, &header, HEADER_SIZE * sizeof(uint32_t), 0);
+
+    if (header.base.generic.type == HEADER_TYPE_STD)
+    {
+        p_record->severity = header.base.std.severity;
+        p_record->count = header.base.std.nargs;
+        p_record->payload.args[0] = header.base.std.addr;
+
+        nrf_memobj_read(p_msg,
+                        &p_record->payload.args[1],
+                        p_record->count * sizeof(uint32_t),
+                        HEADER_SIZE * sizeof(uint32_t));
+
+        p_record->words = crash_log_record_hdr_words + 1 + p_record->count;
+    }
+    else if (header.base.generic.type == HEADER_TYPE_HEXDUMP)
+    {
+        length = MIN(header.base.hexdump.len, crash_log_hexdump_max);
+
+        p_record->severity = header.base.hexdump.severity;
+        p_record->count = length;
+
+        nrf_memobj_read(p_msg,
+                        p_record->payload.data,
+                        length,
+                        HEADER_SIZE * sizeof(uint32_t));
+
+        p_record->words = crash_log_record_hdr_words + CEIL_DIV(length, sizeof(uint32_t));
+    }
+    else
+    {
+        nrf_memobj_put(p_msg);
+        return;
+    }
+
+    nrf_memobj_put(p_msg);
+
+    p_record->type = header.base.generic.type;
+    p_record->module_id = header.module_id;
+    p_record->reserved = 0;
+
+    crash_log_write(&crash_log_ram, buf.words, p_record->words);
+}
+
+static void crash_log_panic_set(nrf_log_backend_t const *p_backend)
+{
+
+}
+
+static void crash_log_flush(nrf_log_backend_t const *p_backend)
+{
+
+}
+
+static const nrf_log_backend_api_t crash_log_api = {
+    .put = crash_log_put,
+    .panic_set = crash_log_panic_set,
+    .flush = crash_log_flush,
+};
+
+NRF_LOG_BACKEND_DEF(crash_log_backend, crash_log_api, NULL);
+
+/* the fault handlers flush the logger, the rest of the ring is written by
+ * the backend; this only adds where the fault happened */
+void HardFault_process(HardFault_stack_t *p_stack)
+{
+    NRF_LOG_ERROR("hard fault: pc 0x%08x lr 0x%08x psr 0x%08x",
+                  p_stack->pc, p_stack->lr, p_stack->psr);
+    NRF_LOG_FINAL_FLUSH();
+
+    NVIC_SystemReset();
+}
+
+static bool crash_log_is_readable(uint32_t address)
+{
+    uint32_t flash_size = NRF_FICR->CODEPAGESIZE * NRF_FICR->CODESIZE;
+    uint32_t ram_size = NRF_FICR->INFO.RAM * 1024;
+
+    return address < flash_size || address - 0x20000000u < ram_size;
+}
+
+/* a %s argument of the previous boot may point anywhere, so everything that
+ * would fault when dereferenced is replaced before the entry is replayed */
+static void crash_log_sanitize(char const *p_fmt, uint32_t *p_args, uint32_t nargs)
+{
+    static char const unknown[] = "?";
+    uint32_t arg = 0;
+
+    while (*p_fmt != '\0' && arg < nargs)
+    {
+        if (*p_fmt++ != '%')
+        {
+            continue;
+        }
+
+        if (*p_fmt == '%')
+        {
+            p_fmt++;
+            continue;
+        }
+
+        p_fmt += strspn(p_fmt, "-+ #0123456789.hlzjt");
+
+        if (*p_fmt == 's' && !crash_log_is_readable(p_args[arg]))
+        {
+            p_args[arg] = (uint32_t)unknown;
+        }
+
+        arg++;
+    }
+}
+
+static void crash_log_replay(crash_log_record_t *p_record)
+{
+    uint32_t severity_mid = p_record->severity
+                            | ((uint32_t)p_record->module_id << NRF_LOG_MODULE_ID_POS);
+    char const *p_fmt = (char const *)p_record->payload.args[0];
+
+    if (p_record->type == HEADER_TYPE_HEXDUMP)
+    {
+        nrf_log_frontend_hexdump(severity_mid,
+                                 p_record->payload.data,
+                                 MIN(p_record->count, crash_log_hexdump_max));
+        return;
+    }
+
+    if (p_record->type != HEADER_TYPE_STD
+        || p_record->count > NRF_LOG_MAX_NUM_OF_ARGS
+        || !crash_log_is_readable((uint32_t)p_fmt))
+    {
+        return;
+    }
+
+    crash_log_sanitize(p_fmt, &p_record->payload.args[1], p_record->count);
+
+    /* the records carry no time, and the clock has restarted since; a zero
+     * stamp sets them apart from the entries of this boot */
+    log_lanes_forward(severity_mid, p_fmt, p_record->count, &p_record->payload.args[1], 0);
+}
+
+/* the replay goes wherever the logs go, so it waits for the port of the
+ * USB log backend */
+static bool crash_log_host_is_ready(void)
+{
+#if LOG_BACKEND_BIN_ENABLED
+    return usb_aux_is_open();
+#elif LOG_BACKEND_USB_ENABLED
+    /* the text backend keeps its port to itself, its class is found by
+     * interface number and the port is open while the host asserts DTR */
+    app_usbd_class_inst_t const *p_inst;
+    uint8_t iface_idx;
+    uint32_t dtr;
+
+    p_inst = app_usbd_iface_find(LOG_BACKEND_USB_CDC_ACM_COMM_INTERFACE, &iface_idx);
+
+    if (p_inst == NULL)
+    {
+        return false;
+    }
+
+    return app_usbd_cdc_acm_line_state_get(app_usbd_cdc_acm_class_get(p_inst),
+                                           APP_USBD_CDC_ACM_LINE_STATE_DTR,
+                                           &dtr) == NRF_SUCCESS
+           && dtr != 0;
+#else
+    return true;
+#endif
+}
+
+void crash_log_init(void)
+{
+    crash_log_ram_t *p_ram = &crash_log_ram;
+    int32_t backend_id;
+
+    crash_log_reset_reason = nrf_power_resetreas_get();
+    nrf_power_resetreas_clear(crash_log_reset_reason);
+
+    if (!crash_log_is_valid(p_ram, &crash_log_old_records))
+    {
+        p_ram->magic = crash_log_magic;
+        p_ram->head = 0;
+        p_ram->tail = 0;
+        crash_log_seal(p_ram);
+
+        crash_log_old_records = 0;
+    }
+
+    crash_log_boundary = p_ram->head;
+    crash_log_draining = crash_log_old_records != 0;
+
+    backend_id = nrf_log_backend_add(&crash_log_backend, CRASH_LOG_SEVERITY);
+
+    if (backend_id < 0)
+    {
+        NRF_LOG_ERROR("cannot add crash log backend");
+        return;
+    }
+
+    nrf_log_backend_enable(&crash_log_backend);
+
+    if (crash_log_draining)
+    {
+        work_signal(WORK_CRASH_LOG);
+    }
+}
+
+void crash_log_process(void)
+{
+    crash_log_ram_t *p_ram = &crash_log_ram;
+    crash_log_buffer_t buf;
+    int i;
+
+    if (!crash_log_draining || !crash_log_host_is_ready())
+    {
+        return;
+    }
+
+    if (!crash_log_announced)
+    {
+        NRF_LOG_WARNING("crash log: %u entries from before reset, RESETREAS 0x%08x",
+                        crash_log_old_records, crash_log_reset_reason);
+        crash_log_announced = true;
+    }
+
+    for (i = 0; i < CRASH_LOG_BATCH; i++)
+    {
+        /* the oldest records may have been evicted by new ones meanwhile */
+        if ((int32_t)(crash_log_boundary - p_ram->tail) <= 0)
+        {
+            NRF_LOG_WARNING("crash log: end");
+            crash_log_draining = false;
+            return;
+        }
+
+        crash_log_read(p_ram, p_ram->tail, &buf);
+
+        p_ram->tail += buf.record.words;
+        crash_log_seal(p_ram);
+
+        /* everything queued so far is recorded as usual, only the replayed
+         * entry itself must not go back into the ring */
+        while (NRF_LOG_PROCESS())
+        {
+        }
+
+        crash_log_replaying = true;
+
+        crash_log_replay(&buf.record);
+
+        while (NRF_LOG_PROCESS())
+        {
+        }
+
+        crash_log_replaying = false;
+    }
+
+    work_signal(WORK_CRASH_LOG);
+}
+
+#endif
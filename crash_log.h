@@ -0,0 +1,29 @@
+#ifndef CRASH_LOG_H
+#define CRASH_LOG_H
+
+#include "sdk_config.h"
+
+/* Crash log in retained RAM.
+ *
+ * A log backend copies every entry, as its format string address and raw
+ * arguments, into a ring kept in the .noinit section, which the startup code
+ * does not clear. The SDK fault handlers end with NRF_LOG_FINAL_FLUSH(), so
+ * whatever was still waiting in the deferred buffer reaches the ring too,
+ * and a hard fault adds its PC and LR before the reset.
+ *
+ * The ring header carries a magic word and a CRC32 and is rewritten after
+ * each record, so a ring found intact after reset holds exactly the records
+ * written before it. RAM is retained over soft, watchdog, lockup and pin
+ * resets, not over power-on or brownout.
+ *
+ * After boot the old records are replayed through the logger in batches from
+ * the main loop, once the host has opened the port of the USB log backend:
+ * the auxiliary port with LOG_BACKEND_BIN_ENABLED, the text port otherwise.
+ * %s arguments are resolved at replay time, so they only print correctly
+ * for strings in flash. */
+
+void crash_log_init(void);
+
+void crash_log_process(void);
+
+#endif
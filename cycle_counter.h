@@ -0,0 +1,23 @@
+#ifndef CYCLE_COUNTER_H
+#define CYCLE_COUNTER_H
+
+#include <stdint.h>
+
+#include "nrf.h"
+
+/* DWT cycle counter. Counts CPU clock cycles (64 MHz) and stops while the
+ * core sleeps, so it measures CPU time rather than wall time. */
+
+static inline void cycle_counter_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t cycle_counter_get(void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif
@@ -0,0 +1,222 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "display_mux.h"
+
+#if DISPLAY_MUX_ENABLED
+
+#include "app_util.h"
+#include "irq_priorities.h"
+#include "nrfx_pwm.h"
+#include "nrfx_ppi.h"
+
+#define NRF_LOG_MODULE_NAME display_mux
+#define NRF_LOG_LEVEL DISPLAY_MUX_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+enum { display_mux_segments = 7 };
+enum { display_mux_lines = display_mux_segments + DISPLAY_MUX_DIGITS };
+enum { display_mux_instances = CEIL_DIV(display_mux_lines, NRF_PWM_CHANNEL_COUNT) };
+
+STATIC_ASSERT(DISPLAY_MUX_DIGITS >= 1 && display_mux_instances <= 3);
+
+/* 1 MHz counting up and down to 500: one 1 ms slot per digit */
+enum { display_mux_top_value = 500 };
+
+/* counts at both ends of the slot in which the commons stay off */
+enum { display_mux_guard = display_mux_top_value / 16 };
+
+/* in up-and-down mode bit 15 set makes the output start high and go low
+ * in the middle while the counter is above the compare value */
+enum { display_mux_falling = 0x8000 };
+
+static nrfx_pwm_t const display_mux_pwm[] = {
+    NRFX_PWM_INSTANCE(1),
+    NRFX_PWM_INSTANCE(2),
+    NRFX_PWM_INSTANCE(3),
+};
+
+/* one step per digit, read by EasyDMA */
+static nrf_pwm_values_individual_t display_mux_steps[display_mux_instances][DISPLAY_MUX_DIGITS];
+static nrf_pwm_sequence_t display_mux_sequences[display_mux_instances];
+
+/* segments a to g in bits 0 to 6 */
+static uint8_t const display_mux_code_b[16] = {
+    0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07,
+    0x7f, 0x6f, 0x40, 0x79, 0x76, 0x38, 0x73, 0x00,
+};
+
+static uint16_t *display_mux_value(uint32_t line, uint32_t digit)
+{
+    /* the four channel fields are consecutive */
+    return &display_mux_steps[line / NRF_PWM_CHANNEL_COUNT][digit].channel_0
+           + line % NRF_PWM_CHANNEL_COUNT;
+}
+
+static uint16_t display_mux_common(uint8_t level)
+{
+    /* the low pulse is twice the distance from the compare value to top */
+    return (display_mux_top_value
+            - level * (display_mux_top_value - display_mux_guard) / display_mux_max_brightness)
+           | display_mux_falling;
+}
+
+void display_mux_digit_set(uint32_t digit, uint8_t value)
+{
+    uint8_t segments;
+    uint32_t i;
+
+    if (digit >= DISPLAY_MUX_DIGITS)
+    {
+        return;
+    }
+
+    segments = display_mux_code_b[value & 0x0f];
+
+    /* with bit 15 clear, 0 keeps the output high and top keeps it low */
+    for (i = 0; i < display_mux_segments; i++)
+    {
+        *display_mux_value(i, digit) = (segments & (1 << i)) ? 0 : display_mux_top_value;
+    }
+}
+
+void display_mux_brightness_set(uint32_t digit, uint8_t level)
+{
+    if (digit >= DISPLAY_MUX_DIGITS)
+    {
+        return;
+    }
+
+    *display_mux_value(display_mux_segments + digit, digit) =
+        display_mux_common(MIN(level, display_mux_max_brightness));
+}
+
+static bool display_mux_pwm_init(uint32_t index, uint8_t const *p_lines)
+{
+    nrfx_pwm_config_t config;
+    nrfx_err_t err;
+    uint32_t line;
+    uint32_t i;
+
+    for (i = 0; i < NRF_PWM_CHANNEL_COUNT; i++)
+    {
+        line = index * NRF_PWM_CHANNEL_COUNT + i;
+
+        if (line >= display_mux_lines)
+        {
+            config.output_pins[i] = NRFX_PWM_PIN_NOT_USED;
+        }
+        else if (line >= display_mux_segments)
+        {
+            /* inactive commons idle high */
+            config.output_pins[i] = p_lines[line] | NRFX_PWM_PIN_INVERTED;
+        }
+        else
+        {
+            config.output_pins[i] = p_lines[line];
+        }
+    }
+
+    config.irq_priority = IRQ_PRIO_DISPLAY_MUX;
+    config.base_clock = NRF_PWM_CLK_1MHz;
+    config.count_mode = NRF_PWM_MODE_UP_AND_DOWN;
+    config.top_value = display_mux_top_value;
+    config.load_mode = NRF_PWM_LOAD_INDIVIDUAL;
+    config.step_mode = NRF_PWM_STEP_AUTO;
+
+    /* no handler, the scan never interrupts */
+    err = nrfx_pwm_init(&display_mux_pwm[index], &config, NULL);
+
+    if (err != NRFX_SUCCESS)
+    {
+        NRF_LOG_ERROR("PWM%u init failed: 0x%x", index + 1, err);
+        return false;
+    }
+
+    display_mux_sequences[index].values.p_individual = display_mux_steps[index];
+    display_mux_sequences[index].length = NRF_PWM_VALUES_LENGTH(display_mux_steps[index]);
+    display_mux_sequences[index].repeats = 0;
+    display_mux_sequences[index].end_delay = 0;
+
+    return true;
+}
+
+void display_mux_init(uint8_t const *p_segment_pins, uint8_t const *p_digit_pins)
+{
+    uint8_t lines[display_mux_lines];
+    uint32_t tasks[display_mux_instances];
+    nrf_ppi_channel_t channel;
+    uint32_t digit;
+    uint32_t common;
+    uint32_t i;
+
+    for (i = 0; i < display_mux_lines; i++)
+    {
+        lines[i] = i < display_mux_segments ? p_segment_pins[i]
+                                            : p_digit_pins[i - display_mux_segments];
+    }
+
+    /* every slot keeps all commons but its own inactive */
+    for (digit = 0; digit < DISPLAY_MUX_DIGITS; digit++)
+    {
+        display_mux_digit_set(digit, display_mux_blank);
+
+        for (common = 0; common < DISPLAY_MUX_DIGITS; common++)
+        {
+            *display_mux_value(display_mux_segments + common, digit) = display_mux_common(0);
+        }
+    }
+
+    for (i = 0; i < display_mux_instances; i++)
+    {
+        if (!display_mux_pwm_init(i, lines))
+        {
+            return;
+        }
+
+        /* armed only, started below */
+        tasks[i] = nrfx_pwm_complex_playback(&display_mux_pwm[i],
+                                             &display_mux_sequences[i],
+                                             &display_mux_sequences[i],
+                                             1,
+                                             NRFX_PWM_FLAG_LOOP
+                                             | NRFX_PWM_FLAG_NO_EVT_FINISHED
+                                             | NRFX_PWM_FLAG_START_VIA_TASK);
+    }
+
+    if (nrfx_ppi_channel_alloc(&channel) != NRFX_SUCCESS)
+    {
+        NRF_LOG_ERROR("no PPI channel to start the display");
+        return;
+    }
+
+    /* the other instances start on the same PWM clock edge plus the fixed
+     * PPI delay, well inside the guard */
+    nrfx_ppi_channel_assign(channel,
+                            nrf_pwm_event_address_get(display_mux_pwm[0].p_registers,
+                                                      NRF_PWM_EVENT_SEQSTARTED0),
+                            tasks[1]);
+
+    if (display_mux_instances > 2)
+    {
+        nrfx_ppi_channel_fork_assign(channel, tasks[display_mux_instances - 1]);
+    }
+
+    nrf_pwm_event_clear(display_mux_pwm[display_mux_instances - 1].p_registers,
+                        NRF_PWM_EVENT_SEQSTARTED0);
+    nrfx_ppi_channel_enable(channel);
+
+    *(volatile uint32_t *)tasks[0] = 1;
+
+    while (!nrf_pwm_event_check(display_mux_pwm[display_mux_instances - 1].p_registers,
+                                NRF_PWM_EVENT_SEQSTARTED0))
+    {
+    }
+
+    /* from here on the loop shortcuts keep them in step */
+    nrfx_ppi_channel_disable(channel);
+    nrfx_ppi_channel_free(channel);
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef DISPLAY_MUX_H
+#define DISPLAY_MUX_H
+
+#include <stdint.h>
+
+#include "sdk_config.h"
+
+/* Multiplexed 7-segment display driven directly by PWM.
+ *
+ * The 7 segment lines and the DISPLAY_MUX_DIGITS digit commons are PWM
+ * channels of PWM1 to PWM3, four lines per instance. Every instance loops
+ * a sequence with one individual-load step per digit, so each PWM period
+ * is the scan slot of one digit: the segment channels are fully on or off
+ * for the segments of that digit, and only the common of that digit is
+ * active. The instances run from the same clock with the same period and
+ * are started together through PPI, so they step in lockstep with no
+ * interrupt at all.
+ *
+ * The commons are pulsed in up-and-down mode, centred in the slot, and
+ * their width sets the brightness of each digit. Even at full brightness
+ * a guard is left at both ends of the slot, where the segment lines
+ * change, so no digit shows the segments of its neighbour.
+ *
+ * Changing a digit is a write to the step buffers, which EasyDMA picks up
+ * the next time the step plays. The display is meant for common-cathode
+ * digits: segment lines are active high, commons active low. */
+
+/* MAX7219 code B */
+enum { display_mux_blank = 0x0f };
+
+enum { display_mux_max_brightness = 15 };
+
+#if DISPLAY_MUX_ENABLED
+
+/* 7 segment pins, a to g, then DISPLAY_MUX_DIGITS common pins, digit 0
+ * first */
+void display_mux_init(uint8_t const *p_segment_pins, uint8_t const *p_digit_pins);
+
+/* 0 to 9, or the code B characters -, E, H, L, P and blank for 0x0a to
+ * 0x0f; digits past DISPLAY_MUX_DIGITS are ignored */
+void display_mux_digit_set(uint32_t digit, uint8_t value);
+
+/* 0 to display_mux_max_brightness, 0 turns the digit off */
+void display_mux_brightness_set(uint32_t digit, uint8_t level);
+
+#endif
+
+#endif
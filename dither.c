@@ -0,0 +1,52 @@
+#include <stdint.h>
+
+#include "dither.h"
+
+#if DITHER_ENABLED
+
+#include "pwm_stream.h"
+
+/* duty values with bit 15 set, as in the fixed duty table */
+enum { dither_polarity = 0x8000 };
+
+enum { dither_fraction_bits = 16 };
+
+static uint16_t dither_buffers[2 * DITHER_BUFFER_LENGTH];
+
+static uint16_t dither_top;
+static volatile uint16_t dither_duty;
+
+/* fraction of a PWM count carried into the next period */
+static uint32_t dither_acc;
+
+static void dither_fill(uint16_t *p_values, uint16_t length)
+{
+    /* PWM counts with 16 fractional bits, below (top + 1) << 16 */
+    uint32_t step = (uint32_t)dither_duty * dither_top;
+    uint32_t acc = dither_acc;
+    uint32_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        acc += step;
+        p_values[i] = (uint16_t)(acc >> dither_fraction_bits) | dither_polarity;
+        acc &= (1u << dither_fraction_bits) - 1;
+    }
+
+    dither_acc = acc;
+}
+
+void dither_start(nrfx_pwm_t const *p_pwm, uint16_t top_value)
+{
+    dither_top = top_value;
+    dither_acc = 0;
+
+    pwm_stream_start(p_pwm, dither_buffers, DITHER_BUFFER_LENGTH, 0, dither_fill);
+}
+
+void dither_set(uint16_t duty)
+{
+    dither_duty = duty;
+}
+
+#endif
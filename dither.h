@@ -0,0 +1,31 @@
+#ifndef DITHER_H
+#define DITHER_H
+
+#include <stdint.h>
+
+#include "nrfx_pwm.h"
+#include "sdk_config.h"
+
+/* High-resolution duty cycle by delta-sigma dithering.
+ *
+ * The requested duty cycle has 16 bits, the PWM only top_value + 1 steps.
+ * Every PWM period of the pwm_stream buffers gets the integer part of the
+ * duty cycle in PWM counts, plus one count whenever a first-order
+ * accumulator of the fractional parts overflows. The carrier frequency is
+ * unchanged and the average duty cycle matches the 16-bit value: the
+ * accumulator carries the rounding error over from period to period and
+ * buffer to buffer, so the error never adds up. The price is a ripple of
+ * one PWM count at the rate the accumulator overflows, which gets slow
+ * for duty cycles just off a whole count. */
+
+#if DITHER_ENABLED
+
+/* p_pwm must be set up as pwm_stream_start() requires */
+void dither_start(nrfx_pwm_t const *p_pwm, uint16_t top_value);
+
+/* 0 to 65535 for 0 to 65535/65536 of the period, from the next buffer */
+void dither_set(uint16_t duty);
+
+#endif
+
+#endif
@@ -0,0 +1,347 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "dsp.h"
+
+#if defined(__ARM_FEATURE_DSP)
+#include "nrf.h"
+#endif
+
+/* one sine period in 256 steps, Q15, with the first step repeated at the
+ * end so the interpolation never wraps */
+static int16_t const dsp_sine[257] = {
+         0,    804,   1608,   2410,   3212,   4011,   4808,   5602,
+      6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
+     12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+     18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+     23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+     27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+     30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,
+     32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+     32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+     32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+     30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,
+     27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+     23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,
+     18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+     12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+      6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
+         0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,
+     -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+    -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+    -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+    -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,
+     -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
+         0,
+};
+
+static int32_t dsp_ssat16(int32_t x)
+{
+    if (x > INT16_MAX)
+    {
+        return INT16_MAX;
+    }
+
+    if (x < INT16_MIN)
+    {
+        return INT16_MIN;
+    }
+
+    return x;
+}
+
+/* 14 bits of fraction between two table steps */
+static uint32_t dsp_nco_frac(uint32_t phase)
+{
+    return (phase >> 10) & 0x3fff;
+}
+
+void dsp_nco_q15_ref(dsp_nco_t *p_nco, int16_t *p_out, uint32_t n)
+{
+    uint32_t phase = p_nco->phase;
+    uint32_t index;
+    int32_t frac;
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        index = phase >> 24;
+        frac = dsp_nco_frac(phase);
+
+        p_out[i] = (dsp_sine[index] * (0x4000 - frac) + dsp_sine[index + 1] * frac) >> 14;
+
+        phase += p_nco->phase_inc;
+    }
+
+    p_nco->phase = phase;
+}
+
+void dsp_biquad_q15_ref(dsp_biquad_t *p_biquad, int16_t *p_out, int16_t const *p_in, uint32_t n)
+{
+    dsp_biquad_coeffs_t const *p_c = &p_biquad->coeffs;
+    uint32_t acc;
+    int16_t x;
+    int16_t y;
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        x = p_in[i];
+
+        /* products fit in 31 bits, their sum wraps like SMLAD */
+        acc = 1u << 13;
+        acc += (uint32_t)(p_c->b0 * x);
+        acc += (uint32_t)(p_c->b1 * p_biquad->x1);
+        acc += (uint32_t)(p_c->b2 * p_biquad->x2);
+        acc += (uint32_t)(-p_c->a1 * p_biquad->y1);
+        acc += (uint32_t)(-p_c->a2 * p_biquad->y2);
+
+        y = dsp_ssat16((int32_t)acc >> 14);
+
+        p_biquad->x2 = p_biquad->x1;
+        p_biquad->x1 = x;
+        p_biquad->y2 = p_biquad->y1;
+        p_biquad->y1 = y;
+
+        p_out[i] = y;
+    }
+}
+
+void dsp_mix_q15_ref(int16_t *p_out,
+                     int16_t const *p_a, int16_t gain_a,
+                     int16_t const *p_b, int16_t gain_b,
+                     uint32_t n)
+{
+    uint32_t acc;
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        acc = 1u << 14;
+        acc += (uint32_t)(p_a[i] * gain_a);
+        acc += (uint32_t)(p_b[i] * gain_b);
+
+        p_out[i] = dsp_ssat16((int32_t)acc >> 15);
+    }
+}
+
+void dsp_scale_to_duty_ref(uint16_t *p_out, int16_t const *p_in,
+                           uint16_t top_value, uint16_t flags, uint32_t n)
+{
+    /* rounded up, so -1.0 maps to 0 for odd top values too */
+    int32_t offset = (top_value + 1) >> 1;
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        p_out[i] = (((p_in[i] * (int32_t)top_value) >> 16) + offset) | flags;
+    }
+}
+
+#if defined(__ARM_FEATURE_DSP)
+
+static inline uint32_t dsp_pack(int16_t lo, int16_t hi)
+{
+    return (uint16_t)lo | ((uint32_t)(uint16_t)hi << 16);
+}
+
+static inline uint32_t dsp_read_q15x2(void const *p)
+{
+    uint32_t v;
+
+    /* a single LDR, the core handles unaligned words */
+    memcpy(&v, p, sizeof(v));
+
+    return v;
+}
+
+static inline void dsp_write_q15x2(void *p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+/* (a * bottom half of b) >> 16 and (a * top half of b) >> 16 */
+static inline int32_t dsp_smulwb(int32_t a, uint32_t b)
+{
+    int32_t r;
+
+    __asm ("smulwb %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+
+    return r;
+}
+
+static inline int32_t dsp_smulwt(int32_t a, uint32_t b)
+{
+    int32_t r;
+
+    __asm ("smulwt %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+
+    return r;
+}
+
+static inline int32_t dsp_nco_sample(uint32_t phase)
+{
+    uint32_t frac = dsp_nco_frac(phase);
+
+    /* both table steps in one load, weighted in one SMUAD */
+    return (int32_t)__SMUAD(dsp_read_q15x2(&dsp_sine[phase >> 24]),
+                            (0x4000 - frac) | (frac << 16)) >> 14;
+}
+
+void dsp_nco_q15(dsp_nco_t *p_nco, int16_t *p_out, uint32_t n)
+{
+    uint32_t phase = p_nco->phase;
+    uint32_t phase_inc = p_nco->phase_inc;
+    int32_t s0;
+    int32_t s1;
+    uint32_t i;
+
+    for (i = 0; i + 1 < n; i += 2)
+    {
+        s0 = dsp_nco_sample(phase);
+        s1 = dsp_nco_sample(phase + phase_inc);
+        phase += 2 * phase_inc;
+
+        dsp_write_q15x2(&p_out[i], __PKHBT(s0, s1, 16));
+    }
+
+    if (i < n)
+    {
+        p_out[i] = dsp_nco_sample(phase);
+        phase += phase_inc;
+    }
+
+    p_nco->phase = phase;
+}
+
+void dsp_biquad_q15(dsp_biquad_t *p_biquad, int16_t *p_out, int16_t const *p_in, uint32_t n)
+{
+    dsp_biquad_coeffs_t const *p_c = &p_biquad->coeffs;
+    uint32_t b0_b1 = dsp_pack(p_c->b0, p_c->b1);
+    uint32_t b2_na1 = dsp_pack(p_c->b2, -p_c->a1);
+    int32_t na2 = -p_c->a2;
+    int32_t x1 = p_biquad->x1;
+    int32_t x2 = p_biquad->x2;
+    int32_t y1 = p_biquad->y1;
+    int32_t y2 = p_biquad->y2;
+    uint32_t acc;
+    int32_t x;
+    int32_t y;
+    uint32_t i;
+
+    for (i = 0; i < n; i++)
+    {
+        x = p_in[i];
+
+        acc = __SMLAD(__PKHBT(x, x1, 16), b0_b1, 1u << 13);
+        acc = __SMLAD(__PKHBT(x2, y1, 16), b2_na1, acc);
+        acc += (uint32_t)(na2 * y2);
+
+        y = __SSAT((int32_t)acc >> 14, 16);
+
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+
+        p_out[i] = y;
+    }
+
+    p_biquad->x1 = x1;
+    p_biquad->x2 = x2;
+    p_biquad->y1 = y1;
+    p_biquad->y2 = y2;
+}
+
+void dsp_mix_q15(int16_t *p_out,
+                 int16_t const *p_a, int16_t gain_a,
+                 int16_t const *p_b, int16_t gain_b,
+                 uint32_t n)
+{
+    uint32_t gains = dsp_pack(gain_a, gain_b);
+    uint32_t a;
+    uint32_t b;
+    int32_t r0;
+    int32_t r1;
+    uint32_t i;
+
+    for (i = 0; i + 1 < n; i += 2)
+    {
+        a = dsp_read_q15x2(&p_a[i]);
+        b = dsp_read_q15x2(&p_b[i]);
+
+        /* regroup as (a0, b0) and (a1, b1) to weight each pair in one SMLAD */
+        r0 = __SSAT((int32_t)__SMLAD(__PKHBT(a, b, 16), gains, 1u << 14) >> 15, 16);
+        r1 = __SSAT((int32_t)__SMLAD(__PKHTB(b, a, 16), gains, 1u << 14) >> 15, 16);
+
+        dsp_write_q15x2(&p_out[i], __PKHBT(r0, r1, 16));
+    }
+
+    if (i < n)
+    {
+        dsp_mix_q15_ref(&p_out[i], &p_a[i], gain_a, &p_b[i], gain_b, 1);
+    }
+}
+
+void dsp_scale_to_duty(uint16_t *p_out, int16_t const *p_in,
+                       uint16_t top_value, uint16_t flags, uint32_t n)
+{
+    int32_t offset = (top_value + 1) >> 1;
+    uint32_t x;
+    uint32_t d0;
+    uint32_t d1;
+    uint32_t i;
+
+    for (i = 0; i + 1 < n; i += 2)
+    {
+        x = dsp_read_q15x2(&p_in[i]);
+
+        d0 = (dsp_smulwb(top_value, x) + offset) | flags;
+        d1 = (dsp_smulwt(top_value, x) + offset) | flags;
+
+        dsp_write_q15x2(&p_out[i], __PKHBT(d0, d1, 16));
+    }
+
+    if (i < n)
+    {
+        dsp_scale_to_duty_ref(&p_out[i], &p_in[i], top_value, flags, 1);
+    }
+}
+
+#else
+
+void dsp_nco_q15(dsp_nco_t *p_nco, int16_t *p_out, uint32_t n)
+{
+    dsp_nco_q15_ref(p_nco, p_out, n);
+}
+
+void dsp_biquad_q15(dsp_biquad_t *p_biquad, int16_t *p_out, int16_t const *p_in, uint32_t n)
+{
+    dsp_biquad_q15_ref(p_biquad, p_out, p_in, n);
+}
+
+void dsp_mix_q15(int16_t *p_out,
+                 int16_t const *p_a, int16_t gain_a,
+                 int16_t const *p_b, int16_t gain_b,
+                 uint32_t n)
+{
+    dsp_mix_q15_ref(p_out, p_a, gain_a, p_b, gain_b, n);
+}
+
+void dsp_scale_to_duty(uint16_t *p_out, int16_t const *p_in,
+                       uint16_t top_value, uint16_t flags, uint32_t n)
+{
+    dsp_scale_to_duty_ref(p_out, p_in, top_value, flags, n);
+}
+
+#endif
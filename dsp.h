@@ -0,0 +1,76 @@
+#ifndef DSP_H
+#define DSP_H
+
+#include <stdint.h>
+
+/* Fixed-point kernels for PWM sample generation.
+ *
+ * Samples are Q15, coefficients and gains as noted per kernel, and
+ * accumulators are 32 bits wide, wrapping on overflow the way SMLAD does.
+ * On a core with the DSP extension the kernels use the dual 16-bit
+ * multiply-accumulate and packing instructions, two samples per step where
+ * the samples are independent; elsewhere they are the _ref versions. The
+ * _ref versions are plain C, always built, and produce bit-identical
+ * output, so they can be compiled on the host to check results or generate
+ * test vectors (test/test_dsp.c).
+ *
+ * Buffers need no particular alignment and may be processed in place. */
+
+/* numerically controlled oscillator, a 32-bit phase accumulator read
+ * through a 256-step sine table with linear interpolation */
+typedef struct {
+    uint32_t phase;
+    uint32_t phase_inc;     /* 2^32 per sample is the sample rate */
+} dsp_nco_t;
+
+/* direct form I biquad with Q14 coefficients, so gains up to 2 fit:
+ * y = b0 x + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2]
+ * no coefficient may be -32768 */
+typedef struct {
+    int16_t b0;
+    int16_t b1;
+    int16_t b2;
+    int16_t a1;
+    int16_t a2;
+} dsp_biquad_coeffs_t;
+
+typedef struct {
+    dsp_biquad_coeffs_t coeffs;
+    int16_t x1;
+    int16_t x2;
+    int16_t y1;
+    int16_t y2;
+} dsp_biquad_t;
+
+void dsp_nco_q15(dsp_nco_t *p_nco, int16_t *p_out, uint32_t n);
+
+void dsp_biquad_q15(dsp_biquad_t *p_biquad, int16_t *p_out, int16_t const *p_in, uint32_t n);
+
+/* out = a * gain_a + b * gain_b, gains Q15, saturated */
+void dsp_mix_q15(int16_t *p_out,
+                 int16_t const *p_a, int16_t gain_a,
+                 int16_t const *p_b, int16_t gain_b,
+                 uint32_t n);
+
+/* Q15 full scale to 0..top_value duty cycles with flags (the polarity bit)
+ * ORed in */
+void dsp_scale_to_duty(uint16_t *p_out, int16_t const *p_in,
+                       uint16_t top_value, uint16_t flags, uint32_t n);
+
+void dsp_nco_q15_ref(dsp_nco_t *p_nco, int16_t *p_out, uint32_t n);
+
+void dsp_biquad_q15_ref(dsp_biquad_t *p_biquad, int16_t *p_out, int16_t const *p_in, uint32_t n);
+
+void dsp_mix_q15_ref(int16_t *p_out,
+                     int16_t const *p_a, int16_t gain_a,
+                     int16_t const *p_b, int16_t gain_b,
+                     uint32_t n);
+
+void dsp_scale_to_duty_ref(uint16_t *p_out, int16_t const *p_in,
+                           uint16_t top_value, uint16_t flags, uint32_t n);
+
+/* compares each kernel against its reference and logs the cycles per
+ * sample of both, on the target only (dsp_bench.c) */
+void dsp_benchmark(void);
+
+#endif
@@ -0,0 +1,124 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dsp.h"
+#include "sdk_config.h"
+
+#if DSP_BENCHMARK
+
+#include "cycle_counter.h"
+
+#define NRF_LOG_MODULE_NAME dsp
+#define NRF_LOG_LEVEL DSP_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+/* odd, so the scalar tail of the two-sample kernels is covered too */
+enum { dsp_bench_samples = 127 };
+
+/* Butterworth low-pass at an eighth of the sample rate, Q14 */
+static dsp_biquad_coeffs_t const dsp_bench_lowpass = {
+    .b0 = 1600,
+    .b1 = 3199,
+    .b2 = 1600,
+    .a1 = -15447,
+    .a2 = 5461
+};
+
+static int16_t dsp_bench_a[dsp_bench_samples];
+static int16_t dsp_bench_b[dsp_bench_samples];
+static int16_t dsp_bench_out[2][dsp_bench_samples];
+
+static uint32_t dsp_bench_start;
+
+static void dsp_bench_begin(void)
+{
+    dsp_bench_start = cycle_counter_get();
+}
+
+static uint32_t dsp_bench_end(void)
+{
+    return cycle_counter_get() - dsp_bench_start;
+}
+
+static void dsp_bench_report(char const *p_name,
+                             uint32_t simd,
+                             uint32_t ref,
+                             void const *p_simd_out,
+                             void const *p_ref_out)
+{
+    bool exact = memcmp(p_simd_out, p_ref_out, dsp_bench_samples * sizeof(int16_t)) == 0;
+
+    /* cycles per 100 samples keeps two decimals of a per-sample figure */
+    NRF_LOG_INFO("%s: %u vs %u cycles per 100 samples, %s",
+                 p_name,
+                 simd * 100 / dsp_bench_samples,
+                 ref * 100 / dsp_bench_samples,
+                 exact ? "bit-exact" : "MISMATCH");
+}
+
+void dsp_benchmark(void)
+{
+    uint16_t *p_duty[2] = { (uint16_t *)dsp_bench_out[0], (uint16_t *)dsp_bench_out[1] };
+    uint32_t x = 0x12345678;
+    dsp_nco_t nco[2];
+    dsp_biquad_t biquad[2];
+    uint32_t simd;
+    uint32_t ref;
+    uint32_t i;
+
+    cycle_counter_init();
+
+    for (i = 0; i < dsp_bench_samples; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+
+        dsp_bench_a[i] = x;
+        dsp_bench_b[i] = x >> 16;
+    }
+
+    nco[0].phase = 0;
+    nco[0].phase_inc = 0x0123456;
+    nco[1] = nco[0];
+
+    dsp_bench_begin();
+    dsp_nco_q15(&nco[0], dsp_bench_out[0], dsp_bench_samples);
+    simd = dsp_bench_end();
+    dsp_bench_begin();
+    dsp_nco_q15_ref(&nco[1], dsp_bench_out[1], dsp_bench_samples);
+    ref = dsp_bench_end();
+    dsp_bench_report("nco", simd, ref, dsp_bench_out[0], dsp_bench_out[1]);
+
+    memset(biquad, 0, sizeof(biquad));
+    biquad[0].coeffs = dsp_bench_lowpass;
+    biquad[1].coeffs = dsp_bench_lowpass;
+
+    dsp_bench_begin();
+    dsp_biquad_q15(&biquad[0], dsp_bench_out[0], dsp_bench_a, dsp_bench_samples);
+    simd = dsp_bench_end();
+    dsp_bench_begin();
+    dsp_biquad_q15_ref(&biquad[1], dsp_bench_out[1], dsp_bench_a, dsp_bench_samples);
+    ref = dsp_bench_end();
+    dsp_bench_report("biquad", simd, ref, dsp_bench_out[0], dsp_bench_out[1]);
+
+    dsp_bench_begin();
+    dsp_mix_q15(dsp_bench_out[0], dsp_bench_a, 0x6000, dsp_bench_b, -0x3000, dsp_bench_samples);
+    simd = dsp_bench_end();
+    dsp_bench_begin();
+    dsp_mix_q15_ref(dsp_bench_out[1], dsp_bench_a, 0x6000, dsp_bench_b, -0x3000, dsp_bench_samples);
+    ref = dsp_bench_end();
+    dsp_bench_report("mix", simd, ref, dsp_bench_out[0], dsp_bench_out[1]);
+
+    dsp_bench_begin();
+    dsp_scale_to_duty(p_duty[0], dsp_bench_a, 101, 0x8000, dsp_bench_samples);
+    simd = dsp_bench_end();
+    dsp_bench_begin();
+    dsp_scale_to_duty_ref(p_duty[1], dsp_bench_a, 101, 0x8000, dsp_bench_samples);
+    ref = dsp_bench_end();
+    dsp_bench_report("scale", simd, ref, p_duty[0], p_duty[1]);
+}
+
+#endif
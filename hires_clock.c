@@ -0,0 +1,58 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "hires_clock.h"
+
+#include "nrf.h"
+#include "nrf_timer.h"
+
+#define HIRES_CLOCK_TIMER NRF_TIMER3
+
+static bool hires_clock_started = false;
+
+void hires_clock_init(void)
+{
+    if (hires_clock_started)
+    {
+        return;
+    }
+
+    nrf_timer_task_trigger(HIRES_CLOCK_TIMER, NRF_TIMER_TASK_STOP);
+    nrf_timer_mode_set(HIRES_CLOCK_TIMER, NRF_TIMER_MODE_TIMER);
+    nrf_timer_bit_width_set(HIRES_CLOCK_TIMER, NRF_TIMER_BIT_WIDTH_32);
+    nrf_timer_frequency_set(HIRES_CLOCK_TIMER, NRF_TIMER_FREQ_16MHz);
+    nrf_timer_int_disable(HIRES_CLOCK_TIMER, ~0u);
+    nrf_timer_task_trigger(HIRES_CLOCK_TIMER, NRF_TIMER_TASK_CLEAR);
+    nrf_timer_task_trigger(HIRES_CLOCK_TIMER, NRF_TIMER_TASK_START);
+
+    hires_clock_started = true;
+}
+
+uint32_t hires_clock_now(void)
+{
+    uint32_t primask;
+    uint32_t now;
+
+    /* CC[0] is shared by every context, capture and read it atomically */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    nrf_timer_task_trigger(HIRES_CLOCK_TIMER, NRF_TIMER_TASK_CAPTURE0);
+    now = nrf_timer_cc_read(HIRES_CLOCK_TIMER, NRF_TIMER_CC_CHANNEL0);
+
+    __set_PRIMASK(primask);
+
+    return now;
+}
+
+uint32_t hires_clock_capture_task_address(uint8_t channel)
+{
+    nrf_timer_task_t task = nrf_timer_capture_task_get((nrf_timer_cc_channel_t)channel);
+
+    return (uint32_t)nrf_timer_task_address_get(HIRES_CLOCK_TIMER, task);
+}
+
+uint32_t hires_clock_capture_read(uint8_t channel)
+{
+    return nrf_timer_cc_read(HIRES_CLOCK_TIMER, (nrf_timer_cc_channel_t)channel);
+}
@@ -0,0 +1,28 @@
+#ifndef HIRES_CLOCK_H
+#define HIRES_CLOCK_H
+
+#include <stdint.h>
+
+/* Free-running 32-bit 16 MHz clock on TIMER3.
+ *
+ * CC[0] is used by hires_clock_now(), CC[1..5] are free to be captured by
+ * hardware events through PPI. The clock keeps HFCLK running while it is
+ * started, so only start it when a user needs it. */
+
+enum { hires_clock_freq_hz = 16000000 };
+
+enum { hires_clock_capture_channels = 5 };
+
+void hires_clock_init(void);
+
+uint32_t hires_clock_now(void);
+
+/* Address of the CAPTURE task of channel 1..5, for use as a PPI task endpoint */
+uint32_t hires_clock_capture_task_address(uint8_t channel);
+
+uint32_t hires_clock_capture_read(uint8_t channel);
+
+#define HIRES_CLOCK_TICKS_TO_NS(ticks) \
+    ((uint32_t)(((uint64_t)(ticks) * 1000u) / (hires_clock_freq_hz / 1000000u)))
+
+#endif
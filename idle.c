@@ -0,0 +1,185 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "idle.h"
+
+#include "app_timer.h"
+#include "nrf.h"
+#include "nrf_rtc.h"
+#include "nrfx.h"
+#include "irq_priorities.h"
+#include "work.h"
+
+#define NRF_LOG_MODULE_NAME idle
+#define NRF_LOG_LEVEL IDLE_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+NRF_SECTION_DEF(idle_deadlines, idle_deadline_t const);
+
+#define IDLE_RTC NRF_RTC2
+
+/* RTC needs the compare value at least two ticks ahead of the counter */
+enum { idle_min_sleep_ticks = 2 };
+enum { idle_max_sleep_ticks = APP_TIMER_MAX_CNT_VAL / 2 };
+
+static uint32_t idle_sleep_ticks;
+static uint32_t idle_report_start;
+
+static uint32_t idle_ticks_diff(uint32_t to, uint32_t from)
+{
+    return (to - from) & APP_TIMER_MAX_CNT_VAL;
+}
+
+/* app_timer expires from RTC1 CC[0] and wakes the CPU by itself */
+static uint32_t app_timer_deadline(void)
+{
+    if (!nrf_rtc_int_is_enabled(NRF_RTC1, NRF_RTC_INT_COMPARE0_MASK))
+    {
+        return IDLE_NO_DEADLINE;
+    }
+
+    return idle_ticks_diff(nrf_rtc_cc_get(NRF_RTC1, 0),
+                           nrf_rtc_counter_get(NRF_RTC1));
+}
+
+IDLE_DEADLINE_REGISTER(app_timer, app_timer_deadline, 0);
+
+void RTC2_IRQHandler(void)
+{
+    /* only here to wake the core up */
+    nrf_rtc_event_clear(IDLE_RTC, NRF_RTC_EVENT_COMPARE_0);
+}
+
+void idle_init(void)
+{
+    /* same tick as app_timer, so deadlines share one unit */
+    nrf_rtc_prescaler_set(IDLE_RTC, APP_TIMER_CONFIG_RTC_FREQUENCY);
+    nrf_rtc_event_clear(IDLE_RTC, NRF_RTC_EVENT_COMPARE_0);
+    nrf_rtc_int_disable(IDLE_RTC, NRF_RTC_INT_COMPARE0_MASK);
+
+    NRFX_IRQ_PRIORITY_SET(RTC2_IRQn, IRQ_PRIO_IDLE_RTC);
+    NRFX_IRQ_ENABLE(RTC2_IRQn);
+
+    nrf_rtc_task_trigger(IDLE_RTC, NRF_RTC_TASK_START);
+
+    idle_report_start = nrf_rtc_counter_get(IDLE_RTC);
+}
+
+static uint32_t idle_next_deadline(void)
+{
+    uint32_t deadline = IDLE_NO_DEADLINE;
+    uint32_t count = NRF_SECTION_ITEM_COUNT(idle_deadlines, idle_deadline_t const);
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        idle_deadline_t const *p_deadline =
+            NRF_SECTION_ITEM_GET(idle_deadlines, idle_deadline_t const, i);
+        uint32_t ticks = p_deadline->handler();
+
+        if (ticks == 0)
+        {
+            work_signal(p_deadline->work);
+        }
+
+        if (ticks < deadline)
+        {
+            deadline = ticks;
+        }
+    }
+
+    return deadline;
+}
+
+/* the event register stays set from any SEV since the last WFE, including
+ * the one of every work_signal(), and would end the next sleep at once */
+static void idle_event_clear(void)
+{
+    __SEV();
+    __WFE();
+}
+
+static void idle_sleep(void)
+{
+#if defined(FLOAT_ABI_HARD)
+    /* pending FPU exceptions would keep the core from sleeping */
+    __set_FPSCR(__get_FPSCR() & ~(0x0000009F));
+    (void)__get_FPSCR();
+    NVIC_ClearPendingIRQ(FPU_IRQn);
+#endif
+
+    __WFE();
+}
+
+bool idle_run(void)
+{
+    uint32_t deadline;
+    uint32_t start;
+    uint32_t now;
+
+    /* before looking for work: a work_signal() from here on sets the event
+     * again and the WFE below returns straight away */
+    idle_event_clear();
+
+    deadline = idle_next_deadline();
+
+    if (deadline == 0 || work_pending())
+    {
+        return false;
+    }
+
+    start = nrf_rtc_counter_get(IDLE_RTC);
+
+    if (deadline != IDLE_NO_DEADLINE)
+    {
+        if (deadline < idle_min_sleep_ticks)
+        {
+            deadline = idle_min_sleep_ticks;
+        }
+        else if (deadline > idle_max_sleep_ticks)
+        {
+            deadline = idle_max_sleep_ticks;
+        }
+
+        nrf_rtc_cc_set(IDLE_RTC, 0, (start + deadline) & APP_TIMER_MAX_CNT_VAL);
+        nrf_rtc_event_clear(IDLE_RTC, NRF_RTC_EVENT_COMPARE_0);
+        nrf_rtc_int_enable(IDLE_RTC, NRF_RTC_INT_COMPARE0_MASK);
+    }
+
+    idle_sleep();
+
+    nrf_rtc_int_disable(IDLE_RTC, NRF_RTC_INT_COMPARE0_MASK);
+
+    now = nrf_rtc_counter_get(IDLE_RTC);
+    idle_sleep_ticks += idle_ticks_diff(now, start);
+
+#if IDLE_REPORT_PERIOD_MS
+    if (idle_ticks_diff(now, idle_report_start) >= APP_TIMER_TICKS(IDLE_REPORT_PERIOD_MS))
+    {
+        idle_stats_log();
+    }
+#endif
+
+    return true;
+}
+
+void idle_stats_log(void)
+{
+    uint32_t now = nrf_rtc_counter_get(IDLE_RTC);
+    uint32_t total = idle_ticks_diff(now, idle_report_start);
+
+    if (total == 0)
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("asleep %u.%u%% of %u ms",
+                 (uint32_t)((uint64_t)idle_sleep_ticks * 100 / total),
+                 (uint32_t)((uint64_t)idle_sleep_ticks * 1000 / total % 10),
+                 (uint32_t)((uint64_t)total * 1000 * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1)
+                            / APP_TIMER_CLOCK_FREQ));
+
+    idle_sleep_ticks = 0;
+    idle_report_start = now;
+}
@@ -0,0 +1,42 @@
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nrf_section.h"
+
+/* Tickless idle.
+ *
+ * Every subsystem registers a deadline handler returning the number of
+ * app_timer ticks until it needs the CPU again: 0 when it has work right now,
+ * IDLE_NO_DEADLINE when only one of its own interrupts can create new work.
+ * A subsystem whose deadline has come gets its work bits signalled.
+ * idle_run() takes the earliest deadline, programs a single RTC2 compare for
+ * it and sleeps with WFE until the compare or any other interrupt fires. */
+
+#define IDLE_NO_DEADLINE UINT32_MAX
+
+typedef uint32_t (*idle_deadline_handler_t)(void);
+
+typedef struct {
+    idle_deadline_handler_t handler;
+    uint32_t work;              /* work bits to signal once the deadline is due */
+} idle_deadline_t;
+
+#define IDLE_DEADLINE_REGISTER(_name, _handler, _work)                       \
+    NRF_SECTION_ITEM_REGISTER(idle_deadlines,                                \
+                              static idle_deadline_t const                   \
+                              _name##_idle_deadline) = {                     \
+        .handler = (_handler),                                               \
+        .work = (_work)                                                      \
+    }
+
+void idle_init(void);
+
+/* Returns true if the core actually went to sleep */
+bool idle_run(void);
+
+void idle_stats_log(void);
+
+#endif
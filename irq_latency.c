@@ -0,0 +1,131 @@
+#include <stdint.h>
+
+#include "irq_latency.h"
+
+#if IRQ_LATENCY_ENABLED
+
+#include "hires_clock.h"
+
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "nrfx_ppi.h"
+#include "nrf_spim.h"
+#include "nrf_pwm.h"
+#include "nrf_rtc.h"
+
+#define NRF_LOG_MODULE_NAME irq_latency
+#define NRF_LOG_LEVEL IRQ_LATENCY_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+static char const * const irq_latency_src_names[IRQ_LATENCY_SRC_COUNT] = {
+    [IRQ_LATENCY_SRC_SPIM0] = "SPIM0",
+    [IRQ_LATENCY_SRC_PWM0] = "PWM0",
+    [IRQ_LATENCY_SRC_RTC1] = "RTC1",
+};
+
+static irq_latency_stats_t irq_latency_stats[IRQ_LATENCY_SRC_COUNT];
+
+APP_TIMER_DEF(irq_latency_timer);
+
+/* capture channel 0 belongs to hires_clock_now() */
+static uint8_t irq_latency_channel(irq_latency_src_t src)
+{
+    return 1 + src;
+}
+
+static void irq_latency_route(irq_latency_src_t src, uint32_t event_address)
+{
+    nrf_ppi_channel_t channel;
+
+    if (nrfx_ppi_channel_alloc(&channel) != NRFX_SUCCESS)
+    {
+        NRF_LOG_ERROR("no PPI channel for %s", irq_latency_src_names[src]);
+        return;
+    }
+
+    nrfx_ppi_channel_assign(channel,
+                            event_address,
+                            hires_clock_capture_task_address(irq_latency_channel(src)));
+    nrfx_ppi_channel_enable(channel);
+}
+
+static void irq_latency_timer_handler(void *ctx)
+{
+    irq_latency_log();
+}
+
+void irq_latency_init(void)
+{
+    hires_clock_init();
+
+    /* app_timer expiries come from RTC1 CC[0], route the event out */
+    nrf_rtc_event_enable(NRF_RTC1, NRF_RTC_INT_COMPARE0_MASK);
+
+    irq_latency_route(IRQ_LATENCY_SRC_SPIM0,
+                      nrf_spim_event_address_get(NRF_SPIM0, NRF_SPIM_EVENT_END));
+    irq_latency_route(IRQ_LATENCY_SRC_PWM0,
+                      nrf_pwm_event_address_get(NRF_PWM0, NRF_PWM_EVENT_SEQEND0));
+    irq_latency_route(IRQ_LATENCY_SRC_RTC1,
+                      nrf_rtc_event_address_get(NRF_RTC1, NRF_RTC_EVENT_COMPARE_0));
+
+    app_timer_create(&irq_latency_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     irq_latency_timer_handler);
+
+    app_timer_start(irq_latency_timer,
+                    APP_TIMER_TICKS(IRQ_LATENCY_REPORT_PERIOD_MS),
+                    NULL);
+}
+
+void irq_latency_mark(irq_latency_src_t src)
+{
+    irq_latency_stats_t *p_stats = &irq_latency_stats[src];
+    uint32_t latency;
+
+    latency = hires_clock_now() - hires_clock_capture_read(irq_latency_channel(src));
+
+    CRITICAL_REGION_ENTER();
+
+    if (p_stats->count == 0 || latency < p_stats->min)
+    {
+        p_stats->min = latency;
+    }
+
+    if (latency > p_stats->max)
+    {
+        p_stats->max = latency;
+    }
+
+    p_stats->sum += latency;
+    p_stats->count++;
+
+    CRITICAL_REGION_EXIT();
+}
+
+void irq_latency_log(void)
+{
+    irq_latency_stats_t stats;
+    int src;
+
+    for (src = 0; src < IRQ_LATENCY_SRC_COUNT; src++)
+    {
+        CRITICAL_REGION_ENTER();
+        stats = irq_latency_stats[src];
+        CRITICAL_REGION_EXIT();
+
+        if (stats.count == 0)
+        {
+            continue;
+        }
+
+        NRF_LOG_INFO("%s: %u events, latency min/max/mean %u/%u/%u ns",
+                     irq_latency_src_names[src],
+                     stats.count,
+                     HIRES_CLOCK_TICKS_TO_NS(stats.min),
+                     HIRES_CLOCK_TICKS_TO_NS(stats.max),
+                     HIRES_CLOCK_TICKS_TO_NS(stats.sum / stats.count));
+    }
+}
+
+#endif
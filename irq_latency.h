@@ -0,0 +1,45 @@
+#ifndef IRQ_LATENCY_H
+#define IRQ_LATENCY_H
+
+#include <stdint.h>
+
+#include "sdk_config.h"
+
+/* Interrupt latency harness.
+ *
+ * Each source event is routed through PPI to a capture channel of the
+ * hires clock, so its timestamp is taken by hardware. The handler calls
+ * IRQ_LATENCY_MARK() on entry, which compares the current time against the
+ * capture and keeps the worst case per source. */
+
+typedef enum {
+    IRQ_LATENCY_SRC_SPIM0,
+    IRQ_LATENCY_SRC_PWM0,
+    IRQ_LATENCY_SRC_RTC1,
+    IRQ_LATENCY_SRC_COUNT
+} irq_latency_src_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+} irq_latency_stats_t;
+
+#if IRQ_LATENCY_ENABLED
+
+void irq_latency_init(void);
+
+void irq_latency_mark(irq_latency_src_t src);
+
+void irq_latency_log(void);
+
+#define IRQ_LATENCY_MARK(src) irq_latency_mark(src)
+
+#else
+
+#define IRQ_LATENCY_MARK(src) do { } while (0)
+
+#endif
+
+#endif
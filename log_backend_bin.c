@@ -0,0 +1,320 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "log_backend_bin.h"
+
+#if LOG_BACKEND_BIN_ENABLED
+
+#if !USB_AUX_ENABLED
+#error "LOG_BACKEND_BIN_ENABLED needs USB_AUX_ENABLED, it replaces the text USB backend"
+#endif
+
+#include "usb_aux.h"
+
+#define NRF_LOG_MODULE_NAME log_backend_bin
+#define NRF_LOG_LEVEL LOG_BACKEND_BIN_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#include "nrf_log_backend_interface.h"
+#include "nrf_log_internal.h"
+#include "nrf_memobj.h"
+
+#if LOG_BACKEND_BIN_BENCHMARK
+#include "cycle_counter.h"
+#include "nrf_log_backend_serial.h"
+#endif
+
+enum { log_backend_bin_hdr_size = 8 };
+enum { log_backend_bin_hexdump_max = 64 };
+enum { log_backend_bin_frame_overhead = 4 };    /* sync, type, length */
+
+#if LOG_BACKEND_BIN_PACKED
+#if !NRF_LOG_USES_TIMESTAMP
+#error "LOG_BACKEND_BIN_PACKED needs NRF_LOG_USES_TIMESTAMP"
+#endif
+
+/* flags, timestamp, module id, format address and arguments, each field
+ * but the first a LEB128 varint of up to 5 bytes */
+enum { log_backend_bin_packed_max = 1 + 5 * (3 + NRF_LOG_MAX_NUM_OF_ARGS) };
+enum { log_backend_bin_packed_nargs_pos = 3 };
+enum { log_backend_bin_packed_absolute = 0x40 };
+
+#define LOG_BACKEND_BIN_TIMESTAMP_MASK (UINT32_MAX >> LOG_BACKEND_BIN_TIMESTAMP_SHIFT)
+#endif
+
+typedef struct {
+    uint8_t severity;
+    uint8_t nargs;
+    uint16_t module_id;
+    uint32_t args[1 + NRF_LOG_MAX_NUM_OF_ARGS];   /* format address first */
+} log_backend_bin_std_t;
+
+typedef struct {
+    uint8_t severity;
+    uint8_t reserved;
+    uint16_t module_id;
+    uint8_t data[log_backend_bin_hexdump_max];
+} log_backend_bin_hexdump_t;
+
+#if LOG_BACKEND_BIN_BENCHMARK
+typedef struct {
+    uint32_t messages;
+    uint32_t bin_bytes;
+    uint32_t bin_cycles;
+    uint32_t text_bytes;
+    uint32_t text_cycles;
+    uint32_t fixed_bytes;
+    uint32_t timestamped_bytes;
+} log_backend_bin_bench_t;
+
+static log_backend_bin_bench_t log_backend_bin_bench;
+
+static uint8_t log_backend_bin_text_buffer[64];
+
+#define LOG_BACKEND_BIN_PER_RECORD(bytes, messages) \
+    ((bytes) * 10 / (messages)) / 10, ((bytes) * 10 / (messages)) % 10
+
+static void log_backend_bin_text_sink(void const *p_ctx, char const *p_str, size_t length)
+{
+    log_backend_bin_bench.text_bytes += length;
+}
+#endif
+
+static log_backend_bin_sent_handler_t p_log_backend_bin_sent_handler;
+
+#if LOG_BACKEND_BIN_PACKED
+static uint32_t log_backend_bin_last_timestamp;
+
+/* records left until the next absolute timestamp, 0 forces one */
+static uint32_t log_backend_bin_sync_countdown;
+
+static uint8_t *log_backend_bin_leb128(uint8_t *p_out, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        *p_out++ = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+
+    *p_out++ = (uint8_t)value;
+
+    return p_out;
+}
+
+static uint32_t log_backend_bin_pack(log_backend_bin_std_t const *p_frame,
+                                     uint32_t timestamp,
+                                     bool *p_sent)
+{
+    uint8_t packed[log_backend_bin_packed_max];
+    uint8_t *p_out = &packed[1];
+    uint32_t now = timestamp >> LOG_BACKEND_BIN_TIMESTAMP_SHIFT;
+    uint32_t length;
+    uint32_t i;
+
+    packed[0] = p_frame->severity | (p_frame->nargs << log_backend_bin_packed_nargs_pos);
+
+    if (log_backend_bin_sync_countdown == 0)
+    {
+        packed[0] |= log_backend_bin_packed_absolute;
+        p_out = log_backend_bin_leb128(p_out, now);
+        log_backend_bin_sync_countdown = LOG_BACKEND_BIN_SYNC_INTERVAL;
+    }
+    else
+    {
+        p_out = log_backend_bin_leb128(p_out,
+                                       (now - log_backend_bin_last_timestamp)
+                                       & LOG_BACKEND_BIN_TIMESTAMP_MASK);
+        log_backend_bin_sync_countdown--;
+    }
+
+    log_backend_bin_last_timestamp = now;
+
+    p_out = log_backend_bin_leb128(p_out, p_frame->module_id);
+
+    for (i = 0; i < 1 + p_frame->nargs; i++)
+    {
+        p_out = log_backend_bin_leb128(p_out, p_frame->args[i]);
+    }
+
+    length = p_out - packed;
+
+    *p_sent = usb_aux_frame_send(USB_AUX_FRAME_LOG_PACKED, packed, length);
+
+    if (!*p_sent)
+    {
+        /* the host misses this delta, so the next record carries the full time */
+        log_backend_bin_sync_countdown = 0;
+    }
+
+    return length;
+}
+#endif
+
+/* returns the length of the payload sent, and in p_fixed_length the length
+ * it has in the fixed layout */
+static uint32_t log_backend_bin_encode(nrf_log_entry_t *p_msg, uint32_t *p_fixed_length)
+{
+    nrf_log_header_t header;
+    uint32_t length = 0;
+
+    nrf_memobj_read(p_msg, &header, HEADER_SIZE * sizeof(uint32_t), 0);
+
+    if (header.base.generic.type == HEADER_TYPE_STD)
+    {
+        log_backend_bin_std_t frame;
+        uint32_t nargs = header.base.std.nargs;
+        bool sent;
+
+        frame.severity = header.base.std.severity;
+        frame.nargs = nargs;
+        frame.module_id = header.module_id;
+        frame.args[0] = header.base.std.addr;
+
+        nrf_memobj_read(p_msg,
+                        &frame.args[1],
+                        nargs * sizeof(uint32_t),
+                        HEADER_SIZE * sizeof(uint32_t));
+
+        length = log_backend_bin_hdr_size + nargs * sizeof(uint32_t);
+        *p_fixed_length = length;
+
+#if LOG_BACKEND_BIN_PACKED
+        length = log_backend_bin_pack(&frame, header.timestamp, &sent);
+#else
+        sent = usb_aux_frame_send(USB_AUX_FRAME_LOG, &frame, length);
+#endif
+
+        if (sent && p_log_backend_bin_sent_handler != NULL)
+        {
+            p_log_backend_bin_sent_handler(header.base.std.addr);
+        }
+    }
+    else if (header.base.generic.type == HEADER_TYPE_HEXDUMP)
+    {
+        log_backend_bin_hexdump_t frame;
+        uint32_t data_len = header.base.hexdump.len;
+
+        if (data_len > log_backend_bin_hexdump_max)
+        {
+            data_len = log_backend_bin_hexdump_max;
+        }
+
+        frame.severity = header.base.hexdump.severity;
+        frame.reserved = 0;
+        frame.module_id = header.module_id;
+
+        nrf_memobj_read(p_msg,
+                        frame.data,
+                        data_len,
+                        HEADER_SIZE * sizeof(uint32_t));
+
+        length = offsetof(log_backend_bin_hexdump_t, data) + data_len;
+        *p_fixed_length = length;
+
+        usb_aux_frame_send(USB_AUX_FRAME_LOG_HEXDUMP, &frame, length);
+    }
+
+    return length;
+}
+
+static void log_backend_bin_put(nrf_log_backend_t const *p_backend,
+                                nrf_log_entry_t *p_msg)
+{
+#if LOG_BACKEND_BIN_BENCHMARK
+    log_backend_bin_bench_t *p_bench = &log_backend_bin_bench;
+    uint32_t start;
+    uint32_t length;
+    uint32_t fixed_length;
+
+    nrf_memobj_get(p_msg);
+
+    start = cycle_counter_get();
+    length = log_backend_bin_encode(p_msg, &fixed_length);
+    p_bench->bin_cycles += cycle_counter_get() - start;
+    p_bench->bin_bytes += length + log_backend_bin_frame_overhead;
+    p_bench->fixed_bytes += fixed_length + log_backend_bin_frame_overhead;
+    p_bench->timestamped_bytes += fixed_length + log_backend_bin_frame_overhead
+                                  + sizeof(uint32_t);
+
+    /* the text path formats into a sink that only counts bytes, so the
+     * comparison excludes the USB transfer itself on both sides */
+    start = cycle_counter_get();
+    nrf_log_backend_serial_put(p_backend,
+                               p_msg,
+                               log_backend_bin_text_buffer,
+                               sizeof(log_backend_bin_text_buffer),
+                               log_backend_bin_text_sink);
+    p_bench->text_cycles += cycle_counter_get() - start;
+
+    nrf_memobj_put(p_msg);
+
+    if (++p_bench->messages == LOG_BACKEND_BIN_BENCHMARK_MESSAGES)
+    {
+        NRF_LOG_INFO("%u messages: binary %u B %u cycles, text %u B %u cycles",
+                     p_bench->messages,
+                     p_bench->bin_bytes, p_bench->bin_cycles,
+                     p_bench->text_bytes, p_bench->text_cycles);
+
+        /* in tenths of a byte */
+        NRF_LOG_INFO("bytes per record: fixed %u.%u, with 32-bit timestamp %u.%u, sent %u.%u",
+                     LOG_BACKEND_BIN_PER_RECORD(p_bench->fixed_bytes, p_bench->messages),
+                     LOG_BACKEND_BIN_PER_RECORD(p_bench->timestamped_bytes, p_bench->messages),
+                     LOG_BACKEND_BIN_PER_RECORD(p_bench->bin_bytes, p_bench->messages));
+
+        memset(p_bench, 0, sizeof(*p_bench));
+    }
+#else
+    uint32_t fixed_length;
+
+    nrf_memobj_get(p_msg);
+    log_backend_bin_encode(p_msg, &fixed_length);
+    nrf_memobj_put(p_msg);
+#endif
+}
+
+static void log_backend_bin_panic_set(nrf_log_backend_t const *p_backend)
+{
+
+}
+
+static void log_backend_bin_flush(nrf_log_backend_t const *p_backend)
+{
+
+}
+
+static const nrf_log_backend_api_t log_backend_bin_api = {
+    .put = log_backend_bin_put,
+    .panic_set = log_backend_bin_panic_set,
+    .flush = log_backend_bin_flush,
+};
+
+NRF_LOG_BACKEND_DEF(log_backend_bin, log_backend_bin_api, NULL);
+
+void log_backend_bin_init(void)
+{
+    int32_t backend_id;
+
+#if LOG_BACKEND_BIN_BENCHMARK
+    cycle_counter_init();
+#endif
+
+    backend_id = nrf_log_backend_add(&log_backend_bin, NRF_LOG_SEVERITY_DEBUG);
+
+    if (backend_id < 0)
+    {
+        NRF_LOG_ERROR("cannot add binary backend");
+        return;
+    }
+
+    nrf_log_backend_enable(&log_backend_bin);
+}
+
+void log_backend_bin_sent_handler_set(log_backend_bin_sent_handler_t handler)
+{
+    p_log_backend_bin_sent_handler = handler;
+}
+
+#endif
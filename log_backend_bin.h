@@ -0,0 +1,43 @@
+#ifndef LOG_BACKEND_BIN_H
+#define LOG_BACKEND_BIN_H
+
+#include <stdint.h>
+
+#include "sdk_config.h"
+
+/* Tokenized binary log backend.
+ *
+ * Instead of formatting, every entry is shipped over the auxiliary USB port
+ * as the address of its format string plus the raw argument words:
+ *
+ *     USB_AUX_FRAME_LOG:         severity | nargs | module id (u16) |
+ *                                format address (u32) | args (u32 * nargs)
+ *     USB_AUX_FRAME_LOG_HEXDUMP: severity | 0 | module id (u16) | data
+ *
+ * All fields are little-endian. With LOG_BACKEND_BIN_PACKED, standard entries
+ * are sent instead as
+ *
+ *     USB_AUX_FRAME_LOG_PACKED:  flags | timestamp | module id |
+ *                                format address | args
+ *
+ * where flags holds the severity in bits 0-2, nargs in bits 3-5 and, in bit
+ * 6, whether the timestamp is absolute. Every other field is an unsigned
+ * LEB128 varint. The timestamp counts units of 2^LOG_BACKEND_BIN_TIMESTAMP_SHIFT
+ * ticks of the 16 MHz log clock and, unless absolute, is the difference to
+ * the previous packed record, modulo the width of the shifted clock. An
+ * absolute timestamp is sent every LOG_BACKEND_BIN_SYNC_INTERVAL records and
+ * after a dropped frame.
+ *
+ * tools/aux_decode.py rebuilds the text from the strings in the firmware
+ * ELF. */
+
+/* called with the address field of every standard entry whose frame was
+ * queued on the auxiliary port; the TX ring never discards a queued frame,
+ * so the entry reaches the host once usb_aux_tx_pending() returns 0 */
+typedef void (*log_backend_bin_sent_handler_t)(uint32_t addr);
+
+void log_backend_bin_init(void);
+
+void log_backend_bin_sent_handler_set(log_backend_bin_sent_handler_t handler);
+
+#endif
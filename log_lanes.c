@@ -0,0 +1,209 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hires_clock.h"
+#include "log_lanes.h"
+#include "nrf.h"
+#include "work.h"
+
+#define NRF_LOG_MODULE_NAME log_lanes
+#define NRF_LOG_LEVEL LOG_LANES_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+#include "nrf_log_ctrl.h"
+#include "nrf_log_internal.h"
+NRF_LOG_MODULE_REGISTER();
+
+#include "nrf_atfifo.h"
+#include "nrf_atomic.h"
+
+typedef struct {
+    uint32_t severity_mid;
+    char const *p_str;
+    uint32_t nargs;
+    uint32_t timestamp;
+    uint32_t args[NRF_LOG_MAX_NUM_OF_ARGS];
+} log_lanes_entry_t;
+
+NRF_ATFIFO_DEF(log_lane_error, log_lanes_entry_t, LOG_LANES_ERROR_CAPACITY);
+NRF_ATFIFO_DEF(log_lane_warning, log_lanes_entry_t, LOG_LANES_WARNING_CAPACITY);
+NRF_ATFIFO_DEF(log_lane_info, log_lanes_entry_t, LOG_LANES_INFO_CAPACITY);
+NRF_ATFIFO_DEF(log_lane_debug, log_lanes_entry_t, LOG_LANES_DEBUG_CAPACITY);
+
+static nrf_atfifo_t *log_lanes[LOG_LANE_COUNT];
+
+static nrf_atomic_u32_t log_lanes_dropped[LOG_LANE_COUNT];
+
+/* stamp of the entry being forwarded, and the exception number plus one of
+ * the context forwarding it, 0 when no forward is in progress */
+static uint32_t log_lanes_forward_stamp;
+static volatile uint32_t log_lanes_forward_context;
+
+static char const * const log_lanes_names[LOG_LANE_COUNT] = {
+    [LOG_LANE_ERROR_IDX] = "error",
+    [LOG_LANE_WARNING_IDX] = "warning",
+    [LOG_LANE_INFO_IDX] = "info",
+    [LOG_LANE_DEBUG_IDX] = "debug",
+};
+
+void log_lanes_init(void)
+{
+    NRF_ATFIFO_INIT(log_lane_error);
+    NRF_ATFIFO_INIT(log_lane_warning);
+    NRF_ATFIFO_INIT(log_lane_info);
+    NRF_ATFIFO_INIT(log_lane_debug);
+
+    log_lanes[LOG_LANE_ERROR_IDX] = log_lane_error;
+    log_lanes[LOG_LANE_WARNING_IDX] = log_lane_warning;
+    log_lanes[LOG_LANE_INFO_IDX] = log_lane_info;
+    log_lanes[LOG_LANE_DEBUG_IDX] = log_lane_debug;
+}
+
+void log_lanes_put(log_lane_t lane,
+                   uint32_t severity_mid,
+                   char const *p_str,
+                   uint32_t nargs,
+                   uint32_t const *p_args)
+{
+    nrf_atfifo_item_put_t put_ctx;
+    log_lanes_entry_t *p_entry;
+
+    p_entry = nrf_atfifo_item_alloc(log_lanes[lane], &put_ctx);
+
+    if (p_entry == NULL)
+    {
+        nrf_atomic_u32_add(&log_lanes_dropped[lane], 1);
+        return;
+    }
+
+    p_entry->severity_mid = severity_mid;
+    p_entry->p_str = p_str;
+    p_entry->nargs = nargs;
+#if NRF_LOG_USES_TIMESTAMP
+    p_entry->timestamp = hires_clock_now();
+#else
+    p_entry->timestamp = 0;
+#endif
+    memcpy(p_entry->args, p_args, nargs * sizeof(uint32_t));
+
+    nrf_atfifo_item_put(log_lanes[lane], &put_ctx);
+
+    work_signal(WORK_LOG_LANES);
+}
+
+uint32_t log_lanes_timestamp(void)
+{
+    /* an interrupt logging directly in the middle of a forward gets its
+     * own time, only the forwarding context sees the stored one */
+    if (log_lanes_forward_context == __get_IPSR() + 1)
+    {
+        return log_lanes_forward_stamp;
+    }
+
+    return hires_clock_now();
+}
+
+void log_lanes_forward(uint32_t severity_mid,
+                       char const *p_str,
+                       uint32_t nargs,
+                       uint32_t const *p_args,
+                       uint32_t timestamp)
+{
+    uint32_t const *a = p_args;
+
+    /* the frontend reads the timestamp while it writes the header */
+    log_lanes_forward_stamp = timestamp;
+    log_lanes_forward_context = __get_IPSR() + 1;
+
+    switch (nargs)
+    {
+        case 0:
+            nrf_log_frontend_std_0(severity_mid, p_str);
+            break;
+
+        case 1:
+            nrf_log_frontend_std_1(severity_mid, p_str, a[0]);
+            break;
+
+        case 2:
+            nrf_log_frontend_std_2(severity_mid, p_str, a[0], a[1]);
+            break;
+
+        case 3:
+            nrf_log_frontend_std_3(severity_mid, p_str,
+                                   a[0], a[1], a[2]);
+            break;
+
+        case 4:
+            nrf_log_frontend_std_4(severity_mid, p_str,
+                                   a[0], a[1], a[2], a[3]);
+            break;
+
+        case 5:
+            nrf_log_frontend_std_5(severity_mid, p_str,
+                                   a[0], a[1], a[2], a[3], a[4]);
+            break;
+
+        default:
+            nrf_log_frontend_std_6(severity_mid, p_str,
+                                   a[0], a[1], a[2], a[3], a[4], a[5]);
+            break;
+    }
+
+    log_lanes_forward_context = 0;
+}
+
+static bool log_lanes_forward_next(void)
+{
+    nrf_atfifo_item_get_t get_ctx;
+    log_lanes_entry_t *p_item;
+    log_lanes_entry_t entry;
+    uint32_t dropped;
+    int lane;
+
+    for (lane = 0; lane < LOG_LANE_COUNT; lane++)
+    {
+        dropped = nrf_atomic_u32_fetch_store(&log_lanes_dropped[lane], 0);
+
+        if (dropped != 0)
+        {
+            NRF_LOG_WARNING("%s lane: %u entries dropped", log_lanes_names[lane], dropped);
+            return true;
+        }
+
+        p_item = nrf_atfifo_item_get(log_lanes[lane], &get_ctx);
+
+        if (p_item != NULL)
+        {
+            entry = *p_item;
+            nrf_atfifo_item_free(log_lanes[lane], &get_ctx);
+
+            log_lanes_forward(entry.severity_mid, entry.p_str, entry.nargs, entry.args,
+                              entry.timestamp);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void log_lanes_process(void)
+{
+    int i;
+
+    for (i = 0; i < LOG_LANES_BATCH; i++)
+    {
+        if (!log_lanes_forward_next())
+        {
+            return;
+        }
+
+        /* empty the shared buffer before the next entry goes in, so
+         * nothing forwarded from a lane can be overwritten there */
+        while (NRF_LOG_PROCESS())
+        {
+        }
+    }
+
+    work_signal(WORK_LOG_LANES);
+}
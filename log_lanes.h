@@ -0,0 +1,103 @@
+#ifndef LOG_LANES_H
+#define LOG_LANES_H
+
+#include <stdint.h>
+
+#include "sdk_config.h"
+#include "app_util.h"
+
+/* Per-severity log lanes.
+ *
+ * LOG_LANE_ERROR() and friends store the entry in a lock-free FIFO of its
+ * own severity instead of the shared deferred buffer, so a flood of info
+ * messages from thread context can never overwrite an error logged from an
+ * interrupt: a full lane drops its own newest entries and counts them.
+ * log_lanes_process() runs from the main loop and forwards entries to the
+ * logger in severity order, one at a time, processing each before taking
+ * the next one. Entries keep the time they were logged at, provided the
+ * logger takes its timestamps from log_lanes_timestamp().
+ *
+ * The macros expand to the logger of the calling module, which must include
+ * nrf_log.h itself. */
+
+typedef enum {
+    LOG_LANE_ERROR_IDX,
+    LOG_LANE_WARNING_IDX,
+    LOG_LANE_INFO_IDX,
+    LOG_LANE_DEBUG_IDX,
+    LOG_LANE_COUNT
+} log_lane_t;
+
+void log_lanes_init(void);
+
+void log_lanes_put(log_lane_t lane,
+                   uint32_t severity_mid,
+                   char const *p_str,
+                   uint32_t nargs,
+                   uint32_t const *p_args);
+
+void log_lanes_process(void);
+
+/* Hands a captured entry to the logger frontend, stamped with the time it
+ * was captured at rather than the time it is forwarded at. */
+void log_lanes_forward(uint32_t severity_mid,
+                       char const *p_str,
+                       uint32_t nargs,
+                       uint32_t const *p_args,
+                       uint32_t timestamp);
+
+/* Timestamp function for NRF_LOG_INIT(): hires_clock_now(), except inside
+ * log_lanes_forward() where it reports the stamp of the entry. */
+uint32_t log_lanes_timestamp(void);
+
+#define LOG_LANES_ARGS(...) ((uint32_t const []){ __VA_ARGS__ })
+
+#define LOG_LANES_PUT_0(lane, sev, str)                                      \
+    log_lanes_put(lane, sev, str, 0, NULL)
+#define LOG_LANES_PUT_1(lane, sev, str, a0)                                  \
+    log_lanes_put(lane, sev, str, 1, LOG_LANES_ARGS((uint32_t)(a0)))
+#define LOG_LANES_PUT_2(lane, sev, str, a0, a1)                              \
+    log_lanes_put(lane, sev, str, 2, LOG_LANES_ARGS((uint32_t)(a0),          \
+                                                    (uint32_t)(a1)))
+#define LOG_LANES_PUT_3(lane, sev, str, a0, a1, a2)                          \
+    log_lanes_put(lane, sev, str, 3, LOG_LANES_ARGS((uint32_t)(a0),          \
+                                                    (uint32_t)(a1),          \
+                                                    (uint32_t)(a2)))
+#define LOG_LANES_PUT_4(lane, sev, str, a0, a1, a2, a3)                      \
+    log_lanes_put(lane, sev, str, 4, LOG_LANES_ARGS((uint32_t)(a0),          \
+                                                    (uint32_t)(a1),          \
+                                                    (uint32_t)(a2),          \
+                                                    (uint32_t)(a3)))
+#define LOG_LANES_PUT_5(lane, sev, str, a0, a1, a2, a3, a4)                  \
+    log_lanes_put(lane, sev, str, 5, LOG_LANES_ARGS((uint32_t)(a0),          \
+                                                    (uint32_t)(a1),          \
+                                                    (uint32_t)(a2),          \
+                                                    (uint32_t)(a3),          \
+                                                    (uint32_t)(a4)))
+#define LOG_LANES_PUT_6(lane, sev, str, a0, a1, a2, a3, a4, a5)              \
+    log_lanes_put(lane, sev, str, 6, LOG_LANES_ARGS((uint32_t)(a0),          \
+                                                    (uint32_t)(a1),          \
+                                                    (uint32_t)(a2),          \
+                                                    (uint32_t)(a3),          \
+                                                    (uint32_t)(a4),          \
+                                                    (uint32_t)(a5)))
+
+#define LOG_LANES_PUT_X(N, ...) CONCAT_2(LOG_LANES_PUT_, N)(__VA_ARGS__)
+
+#define LOG_LANES_PUT(lane, level, ...)                                      \
+    if (NRF_LOG_ENABLED && (NRF_LOG_LEVEL >= (level)))                       \
+    {                                                                        \
+        LOG_LANES_PUT_X(NUM_VA_ARGS_LESS_1(__VA_ARGS__),                     \
+                        lane, LOG_SEVERITY_MOD_ID(level), __VA_ARGS__);      \
+    }
+
+#define LOG_LANE_ERROR(...)                                                  \
+    LOG_LANES_PUT(LOG_LANE_ERROR_IDX, NRF_LOG_SEVERITY_ERROR, __VA_ARGS__)
+#define LOG_LANE_WARNING(...)                                                \
+    LOG_LANES_PUT(LOG_LANE_WARNING_IDX, NRF_LOG_SEVERITY_WARNING, __VA_ARGS__)
+#define LOG_LANE_INFO(...)                                                   \
+    LOG_LANES_PUT(LOG_LANE_INFO_IDX, NRF_LOG_SEVERITY_INFO, __VA_ARGS__)
+#define LOG_LANE_DEBUG(...)                                                  \
+    LOG_LANES_PUT(LOG_LANE_DEBUG_IDX, NRF_LOG_SEVERITY_DEBUG, __VA_ARGS__)
+
+#endif
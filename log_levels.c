@@ -0,0 +1,152 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "log_levels.h"
+
+#define NRF_LOG_MODULE_NAME log_levels
+#define NRF_LOG_LEVEL LOG_LEVELS_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#include "nrf_log_backend_interface.h"
+#include "nrf_log_ctrl.h"
+#include "nrf_section.h"
+
+#if LOG_LEVELS_BENCHMARK
+#include "cycle_counter.h"
+#endif
+
+typedef struct {
+    char const *p_module;
+    nrf_log_severity_t severity;
+} log_levels_override_t;
+
+/* runtime levels applied at boot, they cannot raise a module above the
+ * ceiling it was compiled with */
+static const log_levels_override_t log_levels_overrides[] = {
+    { "app",            NRF_LOG_SEVERITY_INFO },
+    { "log_lanes",      NRF_LOG_SEVERITY_WARNING },
+};
+
+NRF_SECTION_DEF(log_backends, nrf_log_backend_t);
+
+bool log_levels_set(char const *p_module, nrf_log_severity_t severity)
+{
+#if NRF_LOG_FILTERS_ENABLED
+    uint32_t module_count = nrf_log_module_cnt_get();
+    uint32_t backend_count = NRF_SECTION_ITEM_COUNT(log_backends, nrf_log_backend_t);
+    uint32_t module_id;
+    uint32_t i;
+
+    for (module_id = 0; module_id < module_count; module_id++)
+    {
+        if (strcmp(nrf_log_module_name_get(module_id, false), p_module) == 0)
+        {
+            break;
+        }
+    }
+
+    if (module_id == module_count)
+    {
+        return false;
+    }
+
+    for (i = 0; i < backend_count; i++)
+    {
+        nrf_log_backend_t const *p_backend =
+            NRF_SECTION_ITEM_GET(log_backends, nrf_log_backend_t, i);
+
+        if (nrf_log_backend_is_enabled(p_backend))
+        {
+            nrf_log_module_filter_set(nrf_log_backend_id_get(p_backend), module_id, severity);
+        }
+    }
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+#if LOG_LEVELS_BENCHMARK
+
+STATIC_ASSERT(LOG_LEVELS_CONFIG_LOG_LEVEL == 3);   /* the sites below need an info ceiling */
+
+enum { log_levels_bench_runs = 8 };
+
+/* kept out of line so tools/log_size.py can report the size of each site */
+static __attribute__((noipa)) void log_levels_bench_empty(void)
+{
+
+}
+
+static __attribute__((noipa)) void log_levels_bench_compiled_out(void)
+{
+    NRF_LOG_DEBUG("log levels benchmark %u", 1);
+}
+
+static __attribute__((noipa)) void log_levels_bench_site(void)
+{
+    NRF_LOG_INFO("log levels benchmark %u", 1);
+}
+
+static uint32_t log_levels_bench_run(void (*p_site)(void))
+{
+    uint32_t cycles = 0;
+    uint32_t start;
+    int i;
+
+    for (i = 0; i < log_levels_bench_runs; i++)
+    {
+        start = cycle_counter_get();
+        p_site();
+        cycles += cycle_counter_get() - start;
+    }
+
+    return cycles / log_levels_bench_runs;
+}
+
+static void log_levels_benchmark(void)
+{
+    uint32_t empty;
+    uint32_t compiled_out;
+    uint32_t filtered;
+    uint32_t enabled;
+
+    cycle_counter_init();
+
+    empty = log_levels_bench_run(log_levels_bench_empty);
+    compiled_out = log_levels_bench_run(log_levels_bench_compiled_out);
+
+    log_levels_set("log_levels", NRF_LOG_SEVERITY_WARNING);
+    filtered = log_levels_bench_run(log_levels_bench_site);
+    log_levels_set("log_levels", NRF_LOG_SEVERITY_INFO);
+
+    enabled = log_levels_bench_run(log_levels_bench_site);
+
+    NRF_LOG_INFO("cycles per site: compiled out %u, filtered %u, enabled %u",
+                 compiled_out - empty, filtered - empty, enabled - empty);
+}
+
+#endif
+
+void log_levels_init(void)
+{
+#if NRF_LOG_FILTERS_ENABLED
+    uint32_t i;
+
+    for (i = 0; i < sizeof(log_levels_overrides) / sizeof(log_levels_overrides[0]); i++)
+    {
+        if (!log_levels_set(log_levels_overrides[i].p_module,
+                            log_levels_overrides[i].severity))
+        {
+            NRF_LOG_WARNING("no module %s", log_levels_overrides[i].p_module);
+        }
+    }
+#endif
+
+#if LOG_LEVELS_BENCHMARK
+    log_levels_benchmark();
+#endif
+}
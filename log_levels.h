@@ -0,0 +1,28 @@
+#ifndef LOG_LEVELS_H
+#define LOG_LEVELS_H
+
+#include <stdbool.h>
+
+#include "sdk_config.h"
+#include "nrf_log_types.h"
+
+/* Log levels of the application modules.
+ *
+ * Every module compiles against its own <MODULE>_CONFIG_LOG_LEVEL ceiling
+ * from app_config.h; sites more verbose than the ceiling are removed by the
+ * preprocessor and cost neither code nor a runtime check.
+ *
+ * Below the ceilings, log_levels_init() applies the override table in
+ * log_levels.c to every enabled backend, and log_levels_set() changes a
+ * module at runtime. Both need NRF_LOG_FILTERS_ENABLED; with it disabled the
+ * ceilings are the only filter and the per-site runtime check goes away too.
+ *
+ * With LOG_LEVELS_BENCHMARK set, log_levels_init() also logs the cycles
+ * spent in a compiled-out, a runtime-filtered and an enabled site.
+ * tools/log_size.py compares the code size of two builds. */
+
+void log_levels_init(void);
+
+bool log_levels_set(char const *p_module, nrf_log_severity_t severity);
+
+#endif
@@ -0,0 +1,243 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "log_stress.h"
+
+#if LOG_STRESS_ENABLED
+
+#if !LOG_BACKEND_BIN_ENABLED
+#error "LOG_STRESS_ENABLED measures the binary USB log backend, enable LOG_BACKEND_BIN_ENABLED"
+#endif
+
+#include "log_backend_bin.h"
+#include "usb_aux.h"
+
+#define NRF_LOG_MODULE_NAME log_stress
+#define NRF_LOG_LEVEL LOG_STRESS_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#include "app_timer.h"
+
+enum { log_stress_tick_ms = 1 };
+
+/* width of the address field of nrf_log_std_header_t */
+#define LOG_STRESS_ADDR_MASK ((1u << 22) - 1)
+
+static const uint32_t log_stress_rates[] = {
+    100, 250, 500, 1000, 2000, 4000, 8000
+};
+
+/* the stress messages are told apart from everything else by the address
+ * of their format string */
+static char const log_stress_fmt_1[] = "stress %u";
+static char const log_stress_fmt_3[] = "stress %u: %u %u";
+static char const log_stress_fmt_6[] = "stress %u: %u %u %u %u %u";
+
+static char const * const log_stress_shapes[] = {
+    log_stress_fmt_1,
+    log_stress_fmt_3,
+    log_stress_fmt_6,
+};
+
+static const uint8_t log_stress_shape_nargs[] = { 1, 3, 6 };
+
+typedef enum {
+    LOG_STRESS_WAIT_PORT,
+    LOG_STRESS_EMIT,
+    LOG_STRESS_SETTLE,
+    LOG_STRESS_DONE
+} log_stress_phase_t;
+
+static log_stress_phase_t log_stress_phase;
+static uint32_t log_stress_shape;
+static uint32_t log_stress_rate;        /* index into log_stress_rates */
+static uint32_t log_stress_elapsed_ms;
+static uint32_t log_stress_busy_ms;     /* until the port had sent it all */
+static uint32_t log_stress_acc;
+static uint32_t log_stress_saturation;
+
+static uint32_t log_stress_emitted;
+static volatile uint32_t log_stress_delivered;
+
+APP_TIMER_DEF(log_stress_timer);
+
+static bool log_stress_is_own(uint32_t addr)
+{
+    uint32_t i;
+
+    for (i = 0; i < sizeof(log_stress_shapes) / sizeof(log_stress_shapes[0]); i++)
+    {
+        if (addr == ((uint32_t)log_stress_shapes[i] & LOG_STRESS_ADDR_MASK))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* from the transmit path of the binary backend, in the logger context */
+static void log_stress_sent_handler(uint32_t addr)
+{
+    if (log_stress_is_own(addr))
+    {
+        log_stress_delivered++;
+    }
+}
+
+static void log_stress_emit(uint32_t seq)
+{
+    switch (log_stress_shape_nargs[log_stress_shape])
+    {
+        case 1:
+            NRF_LOG_INFO(log_stress_fmt_1, seq);
+            break;
+
+        case 3:
+            NRF_LOG_INFO(log_stress_fmt_3, seq, seq + 1, seq + 2);
+            break;
+
+        default:
+            NRF_LOG_INFO(log_stress_fmt_6, seq, seq + 1, seq + 2,
+                         seq + 3, seq + 4, seq + 5);
+            break;
+    }
+}
+
+static void log_stress_step_start(void)
+{
+    log_stress_phase = LOG_STRESS_EMIT;
+    log_stress_elapsed_ms = 0;
+    log_stress_busy_ms = 0;
+    log_stress_acc = 0;
+    log_stress_emitted = 0;
+    log_stress_delivered = 0;
+}
+
+static void log_stress_step_finish(void)
+{
+    uint32_t rate = log_stress_rates[log_stress_rate];
+    uint32_t delivered = log_stress_delivered;
+    uint32_t dropped = log_stress_emitted - delivered;
+
+    NRF_LOG_INFO("%u args @ %u msg/s: %u msg/s delivered, %u of %u dropped",
+                 log_stress_shape_nargs[log_stress_shape],
+                 rate,
+                 delivered * 1000 / log_stress_busy_ms,
+                 dropped,
+                 log_stress_emitted);
+
+    if (dropped == 0)
+    {
+        log_stress_saturation = rate;
+    }
+
+    if (dropped == 0 && ++log_stress_rate < sizeof(log_stress_rates) / sizeof(log_stress_rates[0]))
+    {
+        log_stress_step_start();
+        return;
+    }
+
+    NRF_LOG_INFO("%u args: saturation at %u msg/s",
+                 log_stress_shape_nargs[log_stress_shape],
+                 log_stress_saturation);
+
+    log_stress_rate = 0;
+    log_stress_saturation = 0;
+
+    if (++log_stress_shape < sizeof(log_stress_shapes) / sizeof(log_stress_shapes[0]))
+    {
+        log_stress_step_start();
+        return;
+    }
+
+    log_stress_phase = LOG_STRESS_DONE;
+    app_timer_stop(log_stress_timer);
+}
+
+static void log_stress_timer_handler(void *ctx)
+{
+    log_stress_elapsed_ms += log_stress_tick_ms;
+
+    if (log_stress_phase != LOG_STRESS_DONE && !usb_aux_is_open())
+    {
+        if (log_stress_phase != LOG_STRESS_WAIT_PORT)
+        {
+            /* what is left in the ring is sent once the port reopens, the
+             * step itself is run again from the start */
+            NRF_LOG_WARNING("log port closed, pausing");
+            log_stress_phase = LOG_STRESS_WAIT_PORT;
+        }
+
+        log_stress_elapsed_ms = 0;
+        return;
+    }
+
+    switch (log_stress_phase)
+    {
+        case LOG_STRESS_WAIT_PORT:
+            /* entries of an interrupted step must leave the deferred buffer
+             * before anything is counted again */
+            if (log_stress_elapsed_ms >= LOG_STRESS_SETTLE_MS)
+            {
+                NRF_LOG_INFO("log port open, starting at %u args @ %u msg/s",
+                             log_stress_shape_nargs[log_stress_shape],
+                             log_stress_rates[log_stress_rate]);
+                log_stress_step_start();
+            }
+            break;
+
+        case LOG_STRESS_EMIT:
+            log_stress_acc += log_stress_rates[log_stress_rate] * log_stress_tick_ms;
+
+            while (log_stress_acc >= 1000)
+            {
+                log_stress_acc -= 1000;
+                log_stress_emit(log_stress_emitted++);
+            }
+
+            if (log_stress_elapsed_ms >= LOG_STRESS_STEP_MS)
+            {
+                log_stress_phase = LOG_STRESS_SETTLE;
+                log_stress_busy_ms = log_stress_elapsed_ms;
+            }
+            break;
+
+        case LOG_STRESS_SETTLE:
+            /* delivered means sent to the host, so the step ends only once
+             * the auxiliary port has nothing left to send */
+            if (usb_aux_tx_pending() != 0)
+            {
+                log_stress_busy_ms = log_stress_elapsed_ms;
+            }
+            else if (log_stress_elapsed_ms >= LOG_STRESS_STEP_MS + LOG_STRESS_SETTLE_MS)
+            {
+                log_stress_step_finish();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+void log_stress_init(void)
+{
+    log_backend_bin_sent_handler_set(log_stress_sent_handler);
+
+    app_timer_create(&log_stress_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     log_stress_timer_handler);
+
+    /* nothing is measured before the host has opened the port */
+    log_stress_shape = 0;
+    log_stress_rate = 0;
+    log_stress_phase = LOG_STRESS_WAIT_PORT;
+
+    app_timer_start(log_stress_timer,
+                    APP_TIMER_TICKS(log_stress_tick_ms),
+                    NULL);
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef LOG_STRESS_H
+#define LOG_STRESS_H
+
+#include "sdk_config.h"
+
+/* Log throughput stress mode.
+ *
+ * Emits log messages from a 1 ms app_timer at a ladder of rates, once per
+ * argument shape. The binary backend, the USB log backend in this
+ * configuration, reports every stress message it has queued on the
+ * auxiliary port, from which nothing is discarded. After each step the
+ * generator waits until the port has sent everything to the host, then
+ * logs messages/sec delivered against messages dropped, either in the
+ * deferred buffer or for lack of room in the port's TX ring. At the end of
+ * each shape it logs the saturation point: the highest rate that went
+ * through without a single drop.
+ *
+ * The ladder starts only once the host has opened the port. If the port
+ * closes, the step under way is abandoned and run again from the start
+ * after it reopens. */
+
+void log_stress_init(void);
+
+#endif
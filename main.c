@@ -7,27 +7,123 @@
 #include "nrf_drv_clock.h"
 #include "app_timer.h"
 
+#include "periodic_task.h"
+#include "coro.h"
+#include "irq_priorities.h"
+#include "irq_latency.h"
+#include "hires_clock.h"
+#include "idle.h"
+#include "work.h"
+#include "usb_aux.h"
+#include "log_backend_bin.h"
+#include "log_stress.h"
+#include "log_lanes.h"
+#include "crash_log.h"
+#include "log_levels.h"
+#include "metrics.h"
+#include "profiler.h"
+#include "scope_profile.h"
+#include "stack_usage.h"
+#include "dsp.h"
+#include "waveform.h"
+#include "pwm_stream.h"
+#include "pwm_swap.h"
+#include "dither.h"
+#include "usb_audio.h"
+#include "pwm_channels.h"
+#include "ws2812.h"
+#include "motion.h"
+#include "control.h"
+#include "display_mux.h"
+
 #include "nrfx_spim.h"
 #include "nrfx_pwm.h"
 
+#define NRF_LOG_LEVEL MAIN_CONFIG_LOG_LEVEL
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
 
 #include "nrf_log_backend_usb.h"
+#include "app_usbd.h"
 
 enum { blink_period_on_ms = 250 };
 enum { blink_period_off_ms = 1000 };
 
 enum { counter_upd_period_ms = 250 };
 
+enum { display_intensity = 0x05 }; /* 11/32 intensity */
+enum { display_fade_step_ms = 40 };
+
 enum { led_pin = NRF_GPIO_PIN_MAP(0, 15) };
 enum { pwr_pin = NRF_GPIO_PIN_MAP(0, 13) };
 
 enum { pwm_pin = NRF_GPIO_PIN_MAP(0, 24) };
 
+#if WS2812_ENABLED
+/* the strip data line, one PWM period per bit */
+enum { pwm0_top_value = ws2812_top_value };
+#elif MOTION_ENABLED || CONTROL_ENABLED
+/* 16 kHz for motor and LED drivers, with 1000 duty steps */
+enum { pwm0_top_value = 1000 };
+#else
+enum { pwm0_top_value = 100 };
+#endif
+enum { pwm0_frequency_hz = 16000000 / pwm0_top_value };
+
 nrfx_pwm_t pwm0 = NRFX_PWM_INSTANCE(0);
 
+#if MOTION_ENABLED
+/* one axis per PWM0 channel */
+static uint8_t const motion_pins[] = {
+    pwm_pin,
+    NRF_GPIO_PIN_MAP(1, 10),
+};
+#endif
+
+#if PWM_CHANNELS_ENABLED
+static uint8_t const dimming_pins[] = {
+    NRF_GPIO_PIN_MAP(1, 1),
+    NRF_GPIO_PIN_MAP(1, 2),
+    NRF_GPIO_PIN_MAP(1, 3),
+    NRF_GPIO_PIN_MAP(1, 4),
+    NRF_GPIO_PIN_MAP(1, 5),
+    NRF_GPIO_PIN_MAP(1, 6),
+    NRF_GPIO_PIN_MAP(1, 7),
+    NRF_GPIO_PIN_MAP(1, 8),
+};
+#endif
+
+/* code B, decoded by both display backends */
+enum { display_blank = 0x0f };
+
+#if DISPLAY_MUX_ENABLED
+/* segments a to g */
+static uint8_t const display_segment_pins[] = {
+    NRF_GPIO_PIN_MAP(1, 11),
+    NRF_GPIO_PIN_MAP(1, 12),
+    NRF_GPIO_PIN_MAP(1, 13),
+    NRF_GPIO_PIN_MAP(1, 14),
+    NRF_GPIO_PIN_MAP(1, 15),
+    NRF_GPIO_PIN_MAP(0, 11),
+    NRF_GPIO_PIN_MAP(0, 12),
+};
+
+/* digit commons, rightmost first */
+static uint8_t const display_digit_pins[] = {
+    NRF_GPIO_PIN_MAP(0, 25),
+    NRF_GPIO_PIN_MAP(0, 26),
+    NRF_GPIO_PIN_MAP(0, 27),
+    NRF_GPIO_PIN_MAP(0, 28),
+    NRF_GPIO_PIN_MAP(0, 29),
+};
+
+STATIC_ASSERT(DISPLAY_MUX_DIGITS <= sizeof(display_digit_pins) / sizeof(display_digit_pins[0]));
+
+#if PWM_CHANNELS_ENABLED && (PWM_CHANNELS_INSTANCES & 0x0e)
+#error "DISPLAY_MUX_ENABLED needs PWM1 to PWM3, leave them out of PWM_CHANNELS_INSTANCES"
+#endif
+#else
 enum { spim0_fifo_length = 128 };
 
 typedef enum {
@@ -52,11 +148,14 @@ typedef struct {
     uint8_t data;
 } max7219_data_portion_t;
 
-APP_TIMER_DEF(blinky_timer);
-APP_TIMER_DEF(counter_timer);
-
 NRF_ATFIFO_DEF(spim0_fifo, max7219_data_portion_t, spim0_fifo_length);
 
+static nrf_atomic_u32_t spim0_fifo_level;
+
+METRIC_DEF(spim0_words, METRIC_COUNTER);
+METRIC_DEF(spim0_fifo_peak, METRIC_PEAK);
+METRIC_DEF(spim0_fifo_overflows, METRIC_COUNTER);
+
 enum { spim0_tx_buflen = 2 };
 static volatile uint8_t spim0_tx_buffer[spim0_tx_buflen];
 
@@ -65,13 +164,28 @@ static volatile bool spim0_busy = false;
 static const nrfx_spim_t
 spim_instance = NRFX_SPIM_INSTANCE(0);
 
+SCOPE_PROFILE_DEF(max7219_write);
+SCOPE_PROFILE_DEF(spim0_evt_handler);
+
+static void spim0_evt_handler(nrfx_spim_evt_t const * p_event, void *ctx);
+#endif
+
+APP_TIMER_DEF(blinky_timer);
+PERIODIC_TASK_DEF(counter_task);
+
+SCOPE_PROFILE_DEF(blinky_timer_handler);
+SCOPE_PROFILE_DEF(counter_timer_handler);
+SCOPE_PROFILE_DEF(log_process);
+
 static void blinky_timer_handler(void *ctx)
 {
     static bool led_is_active = true;
 
+    SCOPE_PROFILE_BEGIN(blinky_timer_handler);
+
     nrf_gpio_pin_toggle(led_pin);
 
-    NRF_LOG_INFO("%s: Main LED toggle", __func__);
+    LOG_LANE_INFO("%s: Main LED toggle", __func__);
 
     app_timer_start(blinky_timer,
                     APP_TIMER_TICKS(led_is_active
@@ -80,10 +194,9 @@ static void blinky_timer_handler(void *ctx)
                     NULL);
 
     led_is_active = !led_is_active;
-}
-
-static void spim0_evt_handler(nrfx_spim_evt_t const * p_event, void *ctx);
 
+    SCOPE_PROFILE_END(blinky_timer_handler);
+}
 
 static void led_init(void)
 {
@@ -97,6 +210,7 @@ static void enable_vcc(void)
     nrf_gpio_pin_write(pwr_pin, 0);
 }
 
+#if !DISPLAY_MUX_ENABLED
 static void max7219_put_to_queue(max7219_reg_t reg, uint8_t data)
 {
     nrf_atfifo_item_put_t item_put_ctx;
@@ -109,8 +223,16 @@ static void max7219_put_to_queue(max7219_reg_t reg, uint8_t data)
         data_portion->reg = reg;
         data_portion->data = data;
 
+        /* counted before the SPIM0 handler can take the item and count it out */
+        METRIC_PEAK(spim0_fifo_peak, nrf_atomic_u32_add(&spim0_fifo_level, 1));
+
         nrf_atfifo_item_put(spim0_fifo, &item_put_ctx);
     }
+    else
+    {
+        METRIC_INC(spim0_fifo_overflows);
+        LOG_LANE_ERROR("%s: SPIM0 queue full, reg %d dropped", __func__, reg);
+    }
 }
 
 static void max7219_write_unsafe(max7219_reg_t reg, uint8_t data)
@@ -120,18 +242,26 @@ static void max7219_write_unsafe(max7219_reg_t reg, uint8_t data)
 
     nrfx_spim_xfer_desc_t tx_desc = NRFX_SPIM_XFER_TX(spim0_tx_buffer, spim0_tx_buflen);
     nrfx_spim_xfer(&spim_instance, &tx_desc, 0);
+
+    METRIC_INC(spim0_words);
 }
 
 static void max7219_write(max7219_reg_t reg, uint8_t data)
 {
+    SCOPE_PROFILE_BEGIN(max7219_write);
+
     if (spim0_busy)
     {
-        return max7219_put_to_queue(reg, data);
+        max7219_put_to_queue(reg, data);
     }
+    else
+    {
+        spim0_busy = true;
 
-    spim0_busy = true;
-    
-    max7219_write_unsafe(reg, data);
+        max7219_write_unsafe(reg, data);
+    }
+
+    SCOPE_PROFILE_END(max7219_write);
 }
 
 static void spim0_evt_handler(nrfx_spim_evt_t const * p_event, void *ctx)
@@ -140,19 +270,65 @@ static void spim0_evt_handler(nrfx_spim_evt_t const * p_event, void *ctx)
     max7219_data_portion_t *data_portion_ptr;
     max7219_data_portion_t data_portion;
 
+    IRQ_LATENCY_MARK(IRQ_LATENCY_SRC_SPIM0);
+    STACK_USAGE_MARK();
+
+    SCOPE_PROFILE_BEGIN(spim0_evt_handler);
+
     data_portion_ptr = nrf_atfifo_item_get(spim0_fifo, &item_get_ctx);
 
     if (data_portion_ptr != NULL)
     {
         data_portion = *data_portion_ptr;
         nrf_atfifo_item_free(spim0_fifo, &item_get_ctx);
+        nrf_atomic_u32_sub(&spim0_fifo_level, 1);
 
         max7219_write_unsafe(data_portion.reg, data_portion.data);
     }
     else
     {
         spim0_busy = false;
+        work_signal(WORK_DISPLAY);
+    }
+
+    SCOPE_PROFILE_END(spim0_evt_handler);
+}
+#endif
+
+/* the display the counter writes to: a MAX7219 on SPIM0, or digits
+ * multiplexed directly by PWM */
+static void display_digit_set(uint32_t digit, uint8_t value)
+{
+#if DISPLAY_MUX_ENABLED
+    display_mux_digit_set(digit, value);
+#else
+    max7219_write(max7219_digit_0 + digit, value);
+#endif
+}
+
+/* 0 to 15 */
+static void display_intensity_set(uint8_t level)
+{
+#if DISPLAY_MUX_ENABLED
+    uint32_t i;
+
+    for (i = 0; i < DISPLAY_MUX_DIGITS; i++)
+    {
+        display_mux_brightness_set(i, level);
     }
+#else
+    max7219_write(max7219_intensity, level);
+#endif
+}
+
+static bool display_is_busy(void)
+{
+#if DISPLAY_MUX_ENABLED
+    /* the step buffers are written directly */
+    return false;
+#else
+    return spim0_busy;
+#endif
 }
 
 enum { counter_top = 10000 };
@@ -163,6 +339,11 @@ static void counter_timer_handler(void *ctx)
     int i;
     uint32_t data;
 
+    IRQ_LATENCY_MARK(IRQ_LATENCY_SRC_RTC1);
+    STACK_USAGE_MARK();
+
+    SCOPE_PROFILE_BEGIN(counter_timer_handler);
+
     counter %= counter_top;
     data = counter;
 
@@ -170,22 +351,80 @@ static void counter_timer_handler(void *ctx)
     {
         if (data)
         {
-            max7219_write(max7219_digit_0 + i, data % 10);
+            display_digit_set(i, data % 10);
             data /= 10;
         }
         else
         {
-            max7219_write(max7219_digit_0 + i, 0x0f);
+            display_digit_set(i, display_blank);
         }
     }
 
     counter++;
+
+    SCOPE_PROFILE_END(counter_timer_handler);
 }
 
-static void spim0_display_init(void)
+static coro_t display_init_coro = { .lc = coro_lc_done };
+
+static coro_state_t display_init_thread(coro_t *c)
 {
-    int i;
+#if !DISPLAY_MUX_ENABLED
+    static const max7219_data_portion_t init_seq[] = {
+        { max7219_shutdown, 0 },        /* disable display */
+        { max7219_decode_mode, 0xff },  /* decode all digits */
+        { max7219_intensity, 0x00 },    /* start dark, faded in below */
+        { max7219_scan_limit, 0x07 },   /* display all digits */
+    };
+#endif
+
+    static unsigned int i;
+
+    CORO_BEGIN(c);
+
+#if !DISPLAY_MUX_ENABLED
+    for (i = 0; i < sizeof(init_seq) / sizeof(init_seq[0]); i++)
+    {
+        max7219_write(init_seq[i].reg, init_seq[i].data);
+        CORO_AWAIT(c, !spim0_busy);
+    }
+#endif
+
+    for (i = 0; i < 8; i++)
+    {
+        display_digit_set(i, display_blank);
+        CORO_AWAIT(c, !display_is_busy());
+    }
+
+#if !DISPLAY_MUX_ENABLED
+    max7219_write(max7219_shutdown, 1); /* enable display */
+    CORO_AWAIT(c, !spim0_busy);
+#endif
+
+    for (i = 1; i <= display_intensity; i++)
+    {
+        CORO_DELAY(c, APP_TIMER_TICKS(display_fade_step_ms));
+        display_intensity_set(i);
+        CORO_AWAIT(c, !display_is_busy());
+    }
+
+    periodic_task_start(&counter_task);
+
+    CORO_END(c);
+}
 
+static uint32_t display_deadline(void)
+{
+    /* SPIM0 completions wake the coroutine through their own interrupt,
+     * the PWM display needs no waiting */
+    return coro_deadline(&display_init_coro);
+}
+
+IDLE_DEADLINE_REGISTER(display, display_deadline, WORK_DISPLAY);
+
+#if !DISPLAY_MUX_ENABLED
+static bool spim0_init(void)
+{
     nrfx_err_t err_code;
     nrfx_spim_config_t config = NRFX_SPIM_DEFAULT_CONFIG;
 
@@ -194,35 +433,38 @@ static void spim0_display_init(void)
     config.ss_pin = NRF_GPIO_PIN_MAP(0, 22);
 
     config.frequency = NRF_SPIM_FREQ_1M;
+    config.irq_priority = IRQ_PRIO_SPIM0;
 
     err_code = nrfx_spim_init(&spim_instance, &config, spim0_evt_handler, NULL);
 
     if (err_code != NRFX_SUCCESS)
     {
-        return;
+        return false;
     }
 
     NRF_ATFIFO_INIT(spim0_fifo);
 
-    app_timer_start(blinky_timer,
-                    APP_TIMER_TICKS(blink_period_on_ms),
-                    NULL);
-
-    max7219_write(max7219_shutdown, 0); /* disable display */
-    max7219_write(max7219_decode_mode, 0xff); /* decode all digits */
-    max7219_write(max7219_intensity, 0x05); /* 11/32 intensity */
-    max7219_write(max7219_scan_limit, 0x07); /* display all digits */
+    return true;
+}
+#endif
 
-    for (i = 0; i < 8; i++)
+static void display_init(void)
+{
+#if DISPLAY_MUX_ENABLED
+    display_mux_init(display_segment_pins, display_digit_pins);
+#else
+    if (!spim0_init())
     {
-        max7219_write(max7219_digit_0 + i, 0x0f);
+        return;
     }
+#endif
 
-    max7219_write(max7219_shutdown, 1); /* enable display */
-
-    app_timer_start(counter_timer,
-                    APP_TIMER_TICKS(counter_upd_period_ms),
+    app_timer_start(blinky_timer,
+                    APP_TIMER_TICKS(blink_period_on_ms),
                     NULL);
+
+    CORO_INIT(&display_init_coro);
+    work_signal(WORK_DISPLAY);
 }
 
 static void timers_init(void)
@@ -233,12 +475,149 @@ static void timers_init(void)
                      APP_TIMER_MODE_SINGLE_SHOT,
                      blinky_timer_handler);
 
-    app_timer_create(&counter_timer,
-                     APP_TIMER_MODE_REPEATED,
-                     counter_timer_handler);
+    periodic_task_init(&counter_task,
+                       counter_upd_period_ms,
+                       counter_timer_handler,
+                       NULL);
 }
 
-static uint16_t pwm0_duty_cycles[] = {
+#if (WAVEFORM_ENABLED + USB_AUDIO_ENABLED + WS2812_ENABLED + DITHER_ENABLED \
+     + MOTION_ENABLED + CONTROL_ENABLED) > 1
+#error "only one of WAVEFORM_ENABLED, USB_AUDIO_ENABLED, WS2812_ENABLED, DITHER_ENABLED, MOTION_ENABLED and CONTROL_ENABLED can drive PWM0"
+#endif
+
+#if PWM_CHANNELS_ENABLED && (PWM_CHANNELS_INSTANCES & 0x01) \
+    && (WAVEFORM_ENABLED + USB_AUDIO_ENABLED + WS2812_ENABLED + DITHER_ENABLED \
+        + MOTION_ENABLED + CONTROL_ENABLED) > 0
+#error "PWM0 is one of the PWM_CHANNELS_INSTANCES, leave it out to drive it from another module"
+#endif
+
+/* PWM0 either streams from one of these or loops the duty table */
+#define PWM0_STREAM (WAVEFORM_ENABLED || USB_AUDIO_ENABLED || WS2812_ENABLED || DITHER_ENABLED)
+
+#if PWM0_STREAM
+
+#if WAVEFORM_ENABLED
+static const waveform_t pwm0_waveform = {
+    .shape = WAVEFORM_SINE,
+    .frequency_mhz = 440000,
+    .amplitude = 0x7fff
+};
+#endif
+
+#if WS2812_ENABLED
+enum { strip_step_ms = 20 };
+enum { strip_brightness = 64 };
+
+APP_TIMER_DEF(strip_timer);
+
+/* a rainbow moving along the strip */
+static void strip_timer_handler(void *ctx)
+{
+    static uint8_t offset;
+    uint32_t led;
+    uint8_t hue;
+    uint8_t up;
+
+    for (led = 0; led < WS2812_LEDS; led++)
+    {
+        hue = (uint8_t)(led * 256 / WS2812_LEDS + offset);
+        up = (uint8_t)((hue % 85) * 3 * strip_brightness / 256);
+
+        if (hue < 85)
+        {
+            ws2812_set(led, strip_brightness - up, up, 0);
+        }
+        else if (hue < 170)
+        {
+            ws2812_set(led, 0, strip_brightness - up, up);
+        }
+        else
+        {
+            ws2812_set(led, up, 0, strip_brightness - up);
+        }
+    }
+
+    offset++;
+}
+#endif
+
+#if DITHER_ENABLED
+enum { breathe_step_ms = 10 };
+
+APP_TIMER_DEF(breathe_timer);
+
+/* fades pwm_pin up and down with a squared curve, which needs the fine
+ * steps at the dark end */
+static void breathe_timer_handler(void *ctx)
+{
+    static uint8_t level;
+    static bool rising = true;
+
+    dither_set((uint16_t)(level * level));
+
+    if (level == (rising ? UINT8_MAX : 0))
+    {
+        rising = !rising;
+    }
+
+    level = rising ? level + 1 : level - 1;
+}
+#endif
+
+#elif MOTION_ENABLED
+
+enum { motion_demo_period_ms = 2000 };
+
+APP_TIMER_DEF(motion_demo_timer);
+
+static const motion_profile_t motion_demo_profiles[] = {
+    { .shape = MOTION_TRAPEZOID, .velocity = 2000, .acceleration = 8000, .dwell_ms = 100 },
+    { .shape = MOTION_SCURVE, .velocity = 2000, .acceleration = 8000, .dwell_ms = 100 },
+};
+
+/* the axes swing between the ends in opposite directions, alternating
+ * between the profile shapes */
+static void motion_demo_timer_handler(void *ctx)
+{
+    static uint32_t move;
+    uint16_t targets[] = { 900, 100 };
+
+    if (move & 1)
+    {
+        targets[0] = 100;
+        targets[1] = 900;
+    }
+
+    if (motion_move(targets, &motion_demo_profiles[(move >> 1) & 1]))
+    {
+        move++;
+    }
+}
+
+#elif CONTROL_ENABLED
+
+/* 1 V with gain 1/6 against the 0.6 V reference, 12 bits */
+enum { control_setpoint = 1138 };
+/* duty steps per 256 per count of error and period */
+enum { control_gain = 16 };
+
+/* integral control of the voltage on CONTROL_AIN, e.g. pwm_pin filtered
+ * by an RC network; the duty cycle keeps 8 fractional bits */
+static uint16_t control_integrate(int16_t sample)
+{
+    static int32_t duty;
+
+    duty += (control_setpoint - sample) * control_gain;
+    duty = MAX(0, MIN(duty, pwm0_top_value << 8));
+
+    return (uint16_t)(duty >> 8);
+}
+
+#else
+
+/* played through pwm_swap, so it can be replaced while it plays */
+static const uint16_t pwm0_duty_cycles[] = {
     10 | 0x8000,
     25 | 0x8000,
     50 | 0x8000,
@@ -246,33 +625,75 @@ static uint16_t pwm0_duty_cycles[] = {
     90 | 0x8000
 };
 
-static nrf_pwm_sequence_t pwm0_sequence = {
-    .values.p_common = pwm0_duty_cycles,
-    .length = sizeof(pwm0_duty_cycles) / sizeof(uint16_t),
-    .repeats = 0,
-    .end_delay = 0
-};
+/* one period per value; a table installed over it needs repeats for a
+ * sequence to outlast the swap handler */
+enum { pwm0_duty_repeats = 0 };
+
+#if IRQ_LATENCY_ENABLED
+enum { pwm0_playback_flags = NRFX_PWM_FLAG_SIGNAL_END_SEQ0 };
+#else
+enum { pwm0_playback_flags = 0 };
+#endif
+
+#endif
 
 static void pwm0_evt_handler(nrfx_pwm_evt_type_t evt)
 {
+    /* only SEQEND0 is captured, the other events would be measured against
+     * a capture a whole sequence old */
+    if (evt == NRFX_PWM_EVT_END_SEQ0)
+    {
+        IRQ_LATENCY_MARK(IRQ_LATENCY_SRC_PWM0);
+    }
+
+    STACK_USAGE_MARK();
 
+#if PWM0_STREAM
+    pwm_stream_evt_handler(evt);
+#elif MOTION_ENABLED
+    motion_evt_handler(evt);
+#elif !CONTROL_ENABLED
+    pwm_swap_evt_handler(evt);
+#endif
 }
 
 static void pwm0_init(void)
 {
     nrfx_pwm_config_t config;
     nrfx_err_t err;
-
+#if MOTION_ENABLED
+    uint32_t i;
+#endif
+
+#if PWM_CHANNELS_ENABLED && (PWM_CHANNELS_INSTANCES & 0x01)
+    /* PWM0 is one of the dimming channel instances, only the duty table on
+     * pwm_pin gives way to them; any other PWM0 user fails the build above */
+    return;
+#endif
+
+#if MOTION_ENABLED
+    for (i = 0; i < NRF_PWM_CHANNEL_COUNT; i++)
+    {
+        config.output_pins[i] = i < sizeof(motion_pins) / sizeof(motion_pins[0])
+                                ? motion_pins[i]
+                                : NRFX_PWM_PIN_NOT_USED;
+    }
+#else
     config.output_pins[0] = pwm_pin;
     config.output_pins[1] = NRFX_PWM_PIN_NOT_USED;
     config.output_pins[2] = NRFX_PWM_PIN_NOT_USED;
     config.output_pins[3] = NRFX_PWM_PIN_NOT_USED;
+#endif
 
-    config.irq_priority = 6;
+    config.irq_priority = IRQ_PRIO_PWM0;
     config.base_clock = NRF_PWM_CLK_16MHz;
     config.count_mode = NRF_PWM_MODE_UP;
-    config.top_value = 100;
+    config.top_value = pwm0_top_value;
+#if MOTION_ENABLED
+    config.load_mode = NRF_PWM_LOAD_INDIVIDUAL;
+#else
     config.load_mode = NRF_PWM_LOAD_COMMON;
+#endif
     config.step_mode = NRF_PWM_STEP_AUTO;
 
     err = nrfx_pwm_init(&pwm0, &config, pwm0_evt_handler);
@@ -282,19 +703,92 @@ static void pwm0_init(void)
         return;
     }
 
-    nrfx_pwm_simple_playback(&pwm0, &pwm0_sequence, 1, NRFX_PWM_FLAG_LOOP);
+#if WAVEFORM_ENABLED
+    waveform_start(&pwm0, pwm0_top_value, pwm0_frequency_hz, &pwm0_waveform);
+#elif USB_AUDIO_ENABLED
+    usb_audio_start(&pwm0, pwm0_top_value, pwm0_frequency_hz);
+#elif WS2812_ENABLED
+    ws2812_start(&pwm0);
+
+    app_timer_create(&strip_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     strip_timer_handler);
+    app_timer_start(strip_timer,
+                    APP_TIMER_TICKS(strip_step_ms),
+                    NULL);
+#elif DITHER_ENABLED
+    dither_start(&pwm0, pwm0_top_value);
+
+    app_timer_create(&breathe_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     breathe_timer_handler);
+    app_timer_start(breathe_timer,
+                    APP_TIMER_TICKS(breathe_step_ms),
+                    NULL);
+#elif MOTION_ENABLED
+    motion_init(&pwm0,
+                sizeof(motion_pins) / sizeof(motion_pins[0]),
+                pwm0_top_value,
+                pwm0_frequency_hz);
+
+    app_timer_create(&motion_demo_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     motion_demo_timer_handler);
+    app_timer_start(motion_demo_timer,
+                    APP_TIMER_TICKS(motion_demo_period_ms),
+                    NULL);
+#elif CONTROL_ENABLED
+    control_start(&pwm0, pwm0_top_value, pwm0_frequency_hz, control_integrate);
+#else
+    pwm_swap_start(&pwm0,
+                   pwm0_duty_cycles,
+                   sizeof(pwm0_duty_cycles) / sizeof(pwm0_duty_cycles[0]),
+                   pwm0_duty_repeats,
+                   pwm0_playback_flags);
+#endif
 }
 
 static void logs_init(void)
 {
-    ret_code_t ret = NRF_LOG_INIT(NULL);
+    ret_code_t ret;
+
+#if NRF_LOG_USES_TIMESTAMP
+    hires_clock_init();
+    ret = NRF_LOG_INIT(log_lanes_timestamp);
+#else
+    ret = NRF_LOG_INIT(NULL);
+#endif
     APP_ERROR_CHECK(ret);
 
+#if !LOG_BACKEND_BIN_ENABLED
+    /* the binary backend replaces the text one, and usb_aux then brings up
+     * the USB stack */
     NRF_LOG_DEFAULT_BACKENDS_INIT();
+#endif
+
+    log_lanes_init();
+
+#if USB_AUX_ENABLED
+    usb_aux_init();
+#endif
+
+#if LOG_BACKEND_BIN_ENABLED
+    log_backend_bin_init();
+#endif
+
+#if CRASH_LOG_ENABLED
+    crash_log_init();
+#endif
+
+    log_levels_init();
 }
 
 int main(void)
 {
+#if STACK_USAGE_ENABLED
+    stack_usage_paint();
+#endif
+
     enable_vcc();
     led_init();
 
@@ -304,12 +798,110 @@ int main(void)
     logs_init();
 
     timers_init();
+
+#if IRQ_LATENCY_ENABLED
+    irq_latency_init();
+#endif
+
+#if LOG_STRESS_ENABLED
+    log_stress_init();
+#endif
+
+#if PROFILER_ENABLED
+    profiler_init();
+#endif
+
+#if SCOPE_PROFILE_ENABLED
+    scope_profile_init();
+#endif
+
+#if DSP_BENCHMARK
+    dsp_benchmark();
+#endif
+
+#if STACK_USAGE_ENABLED
+    stack_usage_init();
+#endif
+
     pwm0_init();
-    spim0_display_init();
+
+#if PWM_CHANNELS_ENABLED
+    pwm_channels_init(dimming_pins, sizeof(dimming_pins) / sizeof(dimming_pins[0]));
+#endif
+
+    display_init();
+
+    work_init();
+    idle_init();
+    metrics_init();
+
+    /* USB events queued while the stack came up did not signal anything */
+    work_signal(WORK_LOG | WORK_USB);
 
     while (true)
     {
-        NRF_LOG_PROCESS();
-        LOG_BACKEND_USB_PROCESS();
+        uint32_t work = work_take();
+        bool productive = false;
+
+        if (work & WORK_DISPLAY)
+        {
+            uint16_t lc = display_init_coro.lc;
+
+            display_init_thread(&display_init_coro);
+            productive |= display_init_coro.lc != lc;
+        }
+
+        if (work & WORK_LOG_LANES)
+        {
+            log_lanes_process();
+            productive = true;
+        }
+
+        if (work & WORK_LOG)
+        {
+            SCOPE_PROFILE_BEGIN(log_process);
+
+            if (NRF_LOG_PROCESS())
+            {
+                work_signal(WORK_LOG);
+            }
+            productive = true;
+
+            SCOPE_PROFILE_END(log_process);
+        }
+
+        if (work & WORK_USB)
+        {
+            while (app_usbd_event_queue_process())
+            {
+                productive = true;
+            }
+        }
+
+#if CRASH_LOG_ENABLED
+        /* the replay waits for the host to open the port, which arrives
+         * as a USB event */
+        if (work & (WORK_CRASH_LOG | WORK_USB))
+        {
+            crash_log_process();
+        }
+#endif
+
+#if USB_AUX_ENABLED
+        if (work & WORK_USB_AUX)
+        {
+            usb_aux_process();
+            productive = true;
+        }
+#endif
+
+        work_loop_account(productive);
+
+        /* app_usbd queues its events from the USBD and POWER interrupts
+         * without any hook to signal them, so poll it after every wakeup */
+        if (idle_run())
+        {
+            work_signal(WORK_USB);
+        }
     }
 }
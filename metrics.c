@@ -0,0 +1,84 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "metrics.h"
+
+#include "app_timer.h"
+#include "app_util.h"
+
+#if USB_AUX_ENABLED
+#include "usb_aux.h"
+#endif
+
+NRF_SECTION_DEF(metrics, metric_t const);
+
+/* tools/aux_decode.py walks the section with this stride */
+STATIC_ASSERT(sizeof(metric_t) == 12);
+
+typedef struct {
+    uint32_t sequence;
+    uint16_t period_ms;
+    uint16_t first;
+    uint32_t values[METRICS_FRAME_VALUES];
+} metrics_frame_t;
+
+APP_TIMER_DEF(metrics_timer);
+
+static uint32_t metrics_sequence;
+
+void metrics_peak_update(nrf_atomic_u32_t *p_value, uint32_t value)
+{
+    uint32_t current = *p_value;
+
+    /* a failed exchange reloads current, so this retries only while the
+     * new value is still the higher one */
+    while (value > current && !nrf_atomic_u32_cmp_exch(p_value, &current, value))
+    {
+    }
+}
+
+void metrics_snapshot_send(void)
+{
+#if USB_AUX_ENABLED
+    metrics_frame_t frame;
+    uint32_t count = NRF_SECTION_ITEM_COUNT(metrics, metric_t const);
+    uint32_t n;
+    uint32_t i;
+
+    frame.sequence = metrics_sequence++;
+    frame.period_ms = METRICS_PERIOD_MS;
+
+    for (frame.first = 0; frame.first < count; frame.first += n)
+    {
+        n = MIN(count - frame.first, METRICS_FRAME_VALUES);
+
+        for (i = 0; i < n; i++)
+        {
+            metric_t const *p_metric =
+                NRF_SECTION_ITEM_GET(metrics, metric_t const, frame.first + i);
+
+            frame.values[i] = *p_metric->p_value;
+        }
+
+        usb_aux_frame_send(USB_AUX_FRAME_METRICS,
+                           &frame,
+                           offsetof(metrics_frame_t, values) + n * sizeof(uint32_t));
+    }
+#endif
+}
+
+static void metrics_timer_handler(void *ctx)
+{
+    metrics_snapshot_send();
+}
+
+void metrics_init(void)
+{
+    if (METRICS_PERIOD_MS == 0)
+    {
+        return;
+    }
+
+    app_timer_create(&metrics_timer, APP_TIMER_MODE_REPEATED, metrics_timer_handler);
+    app_timer_start(metrics_timer, APP_TIMER_TICKS(METRICS_PERIOD_MS), NULL);
+}
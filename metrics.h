@@ -0,0 +1,62 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+#include "nrf_atomic.h"
+#include "nrf_section.h"
+#include "sdk_config.h"
+
+/* Metrics registry.
+ *
+ * METRIC_DEF() allocates a 32-bit value and places its descriptor in the
+ * .metrics flash section, so the registry is assembled by the linker and
+ * needs no registration at runtime. Updates are atomic and may be made from
+ * any context.
+ *
+ * Every METRICS_PERIOD_MS all values are sent over the auxiliary USB port in
+ * section order as
+ *
+ *     USB_AUX_FRAME_METRICS: sequence (u32) | period ms (u16) |
+ *                            index of the first value (u16) | values (u32 * n)
+ *
+ * split over several frames when there are more than METRICS_FRAME_VALUES.
+ * Names and types are not sent; tools/aux_decode.py reads the descriptors
+ * from the ELF. */
+
+typedef enum {
+    METRIC_COUNTER,     /* only ever incremented */
+    METRIC_GAUGE,       /* set to the current value */
+    METRIC_PEAK,        /* highest value seen since boot */
+} metric_type_t;
+
+typedef struct {
+    char const *p_name;
+    nrf_atomic_u32_t *p_value;
+    uint8_t type;
+} metric_t;
+
+#define METRIC_DEF(_name, _type)                                             \
+    nrf_atomic_u32_t _name##_metric;                                         \
+    NRF_SECTION_ITEM_REGISTER(metrics,                                       \
+                              static metric_t const _name##_metric_desc) = { \
+        .p_name = #_name,                                                    \
+        .p_value = &_name##_metric,                                          \
+        .type = (_type)                                                      \
+    }
+
+/* makes a metric defined in another file available */
+#define METRIC_DECLARE(_name) extern nrf_atomic_u32_t _name##_metric
+
+#define METRIC_ADD(_name, _n)  ((void)nrf_atomic_u32_add(&_name##_metric, (_n)))
+#define METRIC_INC(_name)      METRIC_ADD(_name, 1)
+#define METRIC_SET(_name, _v)  ((void)nrf_atomic_u32_store(&_name##_metric, (_v)))
+#define METRIC_PEAK(_name, _v) metrics_peak_update(&_name##_metric, (_v))
+
+void metrics_peak_update(nrf_atomic_u32_t *p_value, uint32_t value);
+
+void metrics_init(void);
+
+void metrics_snapshot_send(void);
+
+#endif
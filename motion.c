@@ -0,0 +1,303 @@
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "motion.h"
+
+#if MOTION_ENABLED
+
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "metrics.h"
+
+#define NRF_LOG_MODULE_NAME motion
+#define NRF_LOG_LEVEL MOTION_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+/* duty values with bit 15 set, as in the fixed duty table */
+enum { motion_polarity = 0x8000 };
+
+enum { motion_max_axes = NRF_PWM_CHANNEL_COUNT };
+
+enum { motion_tables = 2 };
+
+typedef struct {
+    nrf_pwm_values_individual_t steps[MOTION_TABLE_STEPS];     /* read by EasyDMA */
+    nrf_pwm_sequence_t ramp;    /* one value per step */
+    nrf_pwm_sequence_t hold;    /* the last step, for the dwell */
+} motion_table_t;
+
+/* one axis of a move */
+typedef struct {
+    float start;
+    float distance;     /* signed */
+    float velocity;     /* cruise */
+    float ramp;         /* duration of the acceleration */
+    float duration;
+} motion_axis_t;
+
+static motion_table_t motion_table[motion_tables];
+
+/* the next table to plan into, and the moves planned and not finished;
+ * the one playing is motion_next - motion_planned */
+static uint8_t motion_next;
+static volatile uint8_t motion_planned;
+
+static nrfx_pwm_t const *p_motion_pwm;
+static uint32_t motion_axis_count;
+static uint16_t motion_top_value;
+static uint32_t motion_frequency_hz;
+
+/* targets of the last move planned */
+static uint16_t motion_position[motion_max_axes];
+
+METRIC_DEF(motion_moves, METRIC_COUNTER);
+
+static uint16_t *motion_value(nrf_pwm_values_individual_t *p_values, uint32_t axis)
+{
+    /* the four channel fields are consecutive */
+    return &p_values->channel_0 + axis;
+}
+
+static void motion_play(uint8_t table)
+{
+    nrfx_pwm_complex_playback(p_motion_pwm,
+                              &motion_table[table].ramp,
+                              &motion_table[table].hold,
+                              1,
+                              0);
+}
+
+void motion_evt_handler(nrfx_pwm_evt_type_t evt)
+{
+    if (evt != NRFX_PWM_EVT_FINISHED)
+    {
+        return;
+    }
+
+    /* the PWM keeps playing the last step until the next move starts */
+    if (--motion_planned > 0)
+    {
+        motion_play((uint8_t)(motion_next - motion_planned) % motion_tables);
+    }
+}
+
+static void motion_axis_plan(motion_axis_t *p_axis,
+                             motion_profile_t const *p_profile,
+                             uint16_t from,
+                             uint16_t to)
+{
+    float distance = fabsf((float)to - (float)from);
+    float velocity = (float)p_profile->velocity;
+    float accel = (float)p_profile->acceleration;
+    /* the distance covered while accelerating to v and braking again is
+     * v * ramp for both shapes, with a ramp of v / a or pi * v / 2a */
+    float ramp_factor = p_profile->shape == MOTION_SCURVE ? (float)M_PI / (2.0f * accel)
+                                                          : 1.0f / accel;
+
+    p_axis->start = from;
+    p_axis->distance = (float)to - (float)from;
+
+    if (distance == 0.0f)
+    {
+        p_axis->velocity = 0.0f;
+        p_axis->ramp = 0.0f;
+        p_axis->duration = 0.0f;
+        return;
+    }
+
+    /* short moves never reach the cruise velocity */
+    if (velocity * velocity * ramp_factor > distance)
+    {
+        velocity = sqrtf(distance / ramp_factor);
+    }
+
+    p_axis->velocity = velocity;
+    p_axis->ramp = velocity * ramp_factor;
+    p_axis->duration = p_axis->ramp + distance / velocity;
+}
+
+/* makes the axis take the ramps and duration of the lead axis, the
+ * slowest one, with the velocity scaled down to its own distance: every
+ * axis then covers the same fraction of its distance at any time, with
+ * the shape of the lead profile and proportionally lower velocity and
+ * acceleration */
+static void motion_axis_follow(motion_axis_t *p_axis, motion_axis_t const *p_lead)
+{
+    if (p_axis == p_lead || p_lead->duration == 0.0f)
+    {
+        return;
+    }
+
+    p_axis->velocity = fabsf(p_axis->distance) / (p_lead->duration - p_lead->ramp);
+    p_axis->ramp = p_lead->ramp;
+    p_axis->duration = p_lead->duration;
+}
+
+/* distance covered t into the acceleration */
+static float motion_ramp_distance(motion_shape_t shape, motion_axis_t const *p_axis, float t)
+{
+    float v = p_axis->velocity;
+    float ramp = p_axis->ramp;
+
+    if (shape == MOTION_SCURVE)
+    {
+        return 0.5f * v * (t - ramp / (float)M_PI * sinf((float)M_PI * t / ramp));
+    }
+
+    return 0.5f * v * t * t / ramp;
+}
+
+static uint16_t motion_axis_at(motion_shape_t shape, motion_axis_t const *p_axis, float t)
+{
+    float distance = fabsf(p_axis->distance);
+    float travelled;
+
+    if (t >= p_axis->duration)
+    {
+        travelled = distance;
+    }
+    else if (t < p_axis->ramp)
+    {
+        travelled = motion_ramp_distance(shape, p_axis, t);
+    }
+    else if (t < p_axis->duration - p_axis->ramp)
+    {
+        travelled = p_axis->velocity * (t - 0.5f * p_axis->ramp);
+    }
+    else
+    {
+        travelled = distance - motion_ramp_distance(shape, p_axis, p_axis->duration - t);
+    }
+
+    if (p_axis->distance < 0.0f)
+    {
+        travelled = -travelled;
+    }
+
+    return (uint16_t)lroundf(p_axis->start + travelled);
+}
+
+bool motion_move(uint16_t const *p_targets, motion_profile_t const *p_profile)
+{
+    motion_axis_t axes[motion_max_axes];
+    motion_table_t *p_table;
+    uint32_t lead = 0;
+    float duration = 0.0f;
+    float step_s;
+    uint32_t step_periods;
+    uint32_t steps;
+    uint32_t axis;
+    uint32_t i;
+    uint8_t table;
+    bool start;
+
+    if (motion_planned == motion_tables)
+    {
+        return false;
+    }
+
+    table = motion_next;
+    p_table = &motion_table[table];
+
+    for (axis = 0; axis < motion_axis_count; axis++)
+    {
+        motion_axis_plan(&axes[axis],
+                         p_profile,
+                         motion_position[axis],
+                         MIN(p_targets[axis], motion_top_value));
+
+        if (axes[axis].duration > duration)
+        {
+            lead = axis;
+            duration = axes[axis].duration;
+        }
+    }
+
+    /* the slowest axis sets the pace, the others arrive with it; the lead
+     * itself comes out unchanged */
+    for (axis = 0; axis < motion_axis_count; axis++)
+    {
+        motion_axis_follow(&axes[axis], &axes[lead]);
+    }
+
+    step_periods = MAX(1, (uint32_t)(MOTION_STEP_US * (uint64_t)motion_frequency_hz / 1000000));
+    steps = MAX(1, (uint32_t)ceilf(duration * motion_frequency_hz / step_periods));
+
+    if (steps > MOTION_TABLE_STEPS)
+    {
+        step_periods = (uint32_t)ceilf(duration * motion_frequency_hz / MOTION_TABLE_STEPS);
+        steps = (uint32_t)ceilf(duration * motion_frequency_hz / step_periods);
+        steps = MIN(steps, MOTION_TABLE_STEPS);
+    }
+
+    step_s = (float)step_periods / motion_frequency_hz;
+
+    /* step i is what has been reached at its end; the last one is the
+     * target, whatever rounding did to the step count */
+    for (i = 0; i < steps; i++)
+    {
+        for (axis = 0; axis < motion_axis_count; axis++)
+        {
+            *motion_value(&p_table->steps[i], axis) =
+                motion_axis_at(p_profile->shape,
+                               &axes[axis],
+                               i + 1 < steps ? (i + 1) * step_s : duration)
+                | motion_polarity;
+        }
+    }
+
+    for (axis = 0; axis < motion_axis_count; axis++)
+    {
+        motion_position[axis] = MIN(p_targets[axis], motion_top_value);
+    }
+
+    p_table->ramp.values.p_individual = p_table->steps;
+    p_table->ramp.length = steps * NRF_PWM_CHANNEL_COUNT;
+    p_table->ramp.repeats = step_periods - 1;
+    p_table->ramp.end_delay = 0;
+
+    p_table->hold.values.p_individual = &p_table->steps[steps - 1];
+    p_table->hold.length = NRF_PWM_CHANNEL_COUNT;
+    p_table->hold.repeats = 0;
+    p_table->hold.end_delay = (uint32_t)((uint64_t)p_profile->dwell_ms * motion_frequency_hz / 1000);
+
+    NRF_LOG_DEBUG("move: %u ms, %u steps of %u periods",
+                  (uint32_t)(duration * 1000.0f), steps, step_periods);
+
+    METRIC_INC(motion_moves);
+
+    /* the handler finds a queued move from motion_next */
+    CRITICAL_REGION_ENTER();
+
+    motion_next = (table + 1) % motion_tables;
+    start = motion_planned++ == 0;
+
+    CRITICAL_REGION_EXIT();
+
+    if (start)
+    {
+        motion_play(table);
+    }
+
+    return true;
+}
+
+bool motion_is_idle(void)
+{
+    return motion_planned == 0;
+}
+
+void motion_init(nrfx_pwm_t const *p_pwm,
+                 uint32_t axes,
+                 uint16_t top_value,
+                 uint32_t pwm_frequency_hz)
+{
+    p_motion_pwm = p_pwm;
+    motion_axis_count = MIN(axes, motion_max_axes);
+    motion_top_value = top_value;
+    motion_frequency_hz = pwm_frequency_hz;
+}
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nrfx_pwm.h"
+#include "sdk_config.h"
+
+/* Motion profiles played from precomputed PWM tables.
+ *
+ * Each PWM channel drives one axis, positions are duty cycles from 0 to
+ * the top value. motion_move() plans a trapezoidal or S-curve move of all
+ * axes and writes the whole of it into a table of individual-load steps.
+ * The axis with the longest move gets the profile as given; the others
+ * take the same ramps and duration at a proportionally lower velocity and
+ * acceleration, so all axes cover the same fraction of their distance at
+ * any time.
+ * The PWM holds each step for its repeat count, one step every
+ * MOTION_STEP_US; a move that would not fit MOTION_TABLE_STEPS gets
+ * longer steps instead. A second one-step sequence holds the targets for
+ * the dwell time as its end delay.
+ *
+ * Two tables are kept, so one move can be planned while another plays.
+ * The CPU only runs at the end of a move, to start the queued one; the
+ * new move takes over at the next PWM period boundary. */
+
+#if MOTION_ENABLED
+
+typedef enum {
+    MOTION_TRAPEZOID,   /* constant acceleration */
+    MOTION_SCURVE       /* acceleration rises and falls as a half sine */
+} motion_shape_t;
+
+typedef struct {
+    motion_shape_t shape;
+    uint32_t velocity;      /* duty counts per second */
+    uint32_t acceleration;  /* duty counts per second squared, peak for S-curves */
+    uint32_t dwell_ms;      /* hold at the targets before the next move */
+} motion_profile_t;
+
+/* p_pwm must be initialized with individual load and automatic steps, one
+ * output per axis, and its handler must pass the events on to
+ * motion_evt_handler() */
+void motion_init(nrfx_pwm_t const *p_pwm,
+                 uint32_t axes,
+                 uint16_t top_value,
+                 uint32_t pwm_frequency_hz);
+
+/* all axes move from the targets of the previous move, 0 at first, to
+ * p_targets and arrive together with the slowest; false if a move is
+ * already waiting */
+bool motion_move(uint16_t const *p_targets, motion_profile_t const *p_profile);
+
+bool motion_is_idle(void);
+
+void motion_evt_handler(nrfx_pwm_evt_type_t evt);
+
+#endif
+
+#endif
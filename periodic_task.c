@@ -0,0 +1,127 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "periodic_task.h"
+#include "metrics.h"
+
+#include "app_util_platform.h"
+
+#define NRF_LOG_MODULE_NAME periodic_task
+#define NRF_LOG_LEVEL PERIODIC_TASK_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+METRIC_DEF(periodic_task_overruns, METRIC_COUNTER);
+
+#define PERIODIC_TASK_TICK_FREQ \
+    (APP_TIMER_CLOCK_FREQ / (APP_TIMER_CONFIG_RTC_FREQUENCY + 1))
+
+static uint32_t ticks_to_us(uint64_t ticks)
+{
+    return (uint32_t)((ticks * 1000000u) / PERIODIC_TASK_TICK_FREQ);
+}
+
+/* RTC1 counter is 24 bits wide, sign-extend the difference */
+static int32_t ticks_diff(uint32_t a, uint32_t b)
+{
+    return (int32_t)(app_timer_cnt_diff_compute(a, b) << 8) >> 8;
+}
+
+static void periodic_task_timeout_handler(void *ctx)
+{
+    periodic_task_t *p_task = ctx;
+    periodic_task_stats_t *p_stats = &p_task->stats;
+    uint32_t release;
+    uint32_t jitter;
+    int32_t lateness;
+
+    release = app_timer_cnt_get();
+
+    if (p_stats->runs == 0)
+    {
+        /* first release defines the phase of the ideal grid */
+        p_task->ideal = release;
+    }
+
+    lateness = ticks_diff(release, p_task->ideal);
+    jitter = lateness < 0 ? -lateness : lateness;
+
+    p_task->handler(p_task->ctx);
+
+    if (ticks_diff(app_timer_cnt_get(), p_task->ideal) >= (int32_t)p_task->period_ticks)
+    {
+        p_stats->missed++;
+        METRIC_INC(periodic_task_overruns);
+    }
+
+    p_task->ideal = (p_task->ideal + p_task->period_ticks) & APP_TIMER_MAX_CNT_VAL;
+
+    if (p_stats->runs == 0 || jitter < p_stats->jitter_min)
+    {
+        p_stats->jitter_min = jitter;
+    }
+
+    if (jitter > p_stats->jitter_max)
+    {
+        p_stats->jitter_max = jitter;
+    }
+
+    p_stats->jitter_sum += jitter;
+    p_stats->runs++;
+
+#if PERIODIC_TASK_REPORT_INTERVAL
+    if (p_stats->runs % PERIODIC_TASK_REPORT_INTERVAL == 0)
+    {
+        periodic_task_stats_log(p_task);
+    }
+#endif
+}
+
+ret_code_t periodic_task_init(periodic_task_t *p_task,
+                              uint32_t period_ms,
+                              periodic_task_handler_t handler,
+                              void *ctx)
+{
+    p_task->handler = handler;
+    p_task->ctx = ctx;
+    p_task->period_ticks = APP_TIMER_TICKS(period_ms);
+
+    memset(&p_task->stats, 0, sizeof(p_task->stats));
+
+    return app_timer_create(p_task->p_timer,
+                            APP_TIMER_MODE_REPEATED,
+                            periodic_task_timeout_handler);
+}
+
+ret_code_t periodic_task_start(periodic_task_t *p_task)
+{
+    return app_timer_start(*p_task->p_timer, p_task->period_ticks, p_task);
+}
+
+void periodic_task_stats_get(periodic_task_t const *p_task,
+                             periodic_task_stats_t *p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = p_task->stats;
+    CRITICAL_REGION_EXIT();
+}
+
+void periodic_task_stats_log(periodic_task_t const *p_task)
+{
+    periodic_task_stats_t stats;
+
+    periodic_task_stats_get(p_task, &stats);
+
+    if (stats.runs == 0)
+    {
+        return;
+    }
+
+    NRF_LOG_INFO("%s: runs %u, missed %u",
+                 p_task->name, stats.runs, stats.missed);
+    NRF_LOG_INFO("%s: jitter min/max/mean %u/%u/%u us",
+                 p_task->name,
+                 ticks_to_us(stats.jitter_min),
+                 ticks_to_us(stats.jitter_max),
+                 ticks_to_us(stats.jitter_sum / stats.runs));
+}
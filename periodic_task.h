@@ -0,0 +1,53 @@
+#ifndef PERIODIC_TASK_H
+#define PERIODIC_TASK_H
+
+#include <stdint.h>
+
+#include "app_timer.h"
+
+/* Periodic task on top of a repeated app_timer.
+ *
+ * Every run records the actual release time against the ideal one
+ * (first release + n * period) and keeps jitter and deadline statistics.
+ * All times are in app_timer (RTC1) ticks. */
+
+typedef void (*periodic_task_handler_t)(void *ctx);
+
+typedef struct {
+    uint32_t runs;
+    uint32_t missed;            /* runs that finished after the next release */
+    uint32_t jitter_min;
+    uint32_t jitter_max;
+    uint64_t jitter_sum;
+} periodic_task_stats_t;
+
+typedef struct {
+    char const *name;
+    app_timer_id_t const *p_timer;
+    periodic_task_handler_t handler;
+    void *ctx;
+    uint32_t period_ticks;
+    uint32_t ideal;             /* ideal release time of the next run */
+    periodic_task_stats_t stats;
+} periodic_task_t;
+
+#define PERIODIC_TASK_DEF(_name)                                             \
+    APP_TIMER_DEF(_name##_timer);                                            \
+    static periodic_task_t _name = {                                         \
+        .name = #_name,                                                      \
+        .p_timer = &_name##_timer                                            \
+    }
+
+ret_code_t periodic_task_init(periodic_task_t *p_task,
+                              uint32_t period_ms,
+                              periodic_task_handler_t handler,
+                              void *ctx);
+
+ret_code_t periodic_task_start(periodic_task_t *p_task);
+
+void periodic_task_stats_get(periodic_task_t const *p_task,
+                             periodic_task_stats_t *p_stats);
+
+void periodic_task_stats_log(periodic_task_t const *p_task);
+
+#endif
@@ -0,0 +1,203 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+
+#include "app_timer.h"
+#include "app_util.h"
+#include "irq_priorities.h"
+#include "nrf.h"
+#include "nrf_timer.h"
+#include "nrfx.h"
+#include "stack_usage.h"
+#include "usb_aux.h"
+
+#define PROFILER_TIMER NRF_TIMER2
+
+STATIC_ASSERT((PROFILER_SLOTS & (PROFILER_SLOTS - 1)) == 0);
+
+enum { profiler_timer_freq_hz = 1000000 };
+enum { profiler_jitter_mask = 0x0f };  /* us added to each sampling period */
+enum { profiler_max_probes = 8 };
+enum { profiler_frame_entries = 32 };
+
+typedef struct {
+    uint32_t keys[PROFILER_SLOTS];      /* PC >> PROFILER_PC_SHIFT, 0 when free */
+    uint16_t counts[PROFILER_SLOTS];
+    uint32_t samples;
+    uint32_t lost;
+} profiler_table_t;
+
+typedef struct {
+    uint32_t bucket;
+    uint32_t samples;
+} profiler_entry_t;
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t samples;
+    uint32_t lost;
+    uint8_t pc_shift;
+    uint8_t reserved;
+    uint16_t count;
+    profiler_entry_t entries[profiler_frame_entries];
+} profiler_frame_t;
+
+APP_TIMER_DEF(profiler_report_timer);
+
+static profiler_table_t profiler_tables[2];
+
+/* only switched by the report, which runs below the sampling priority, so
+ * a sample is never halfway through the table being sent */
+static profiler_table_t * volatile p_profiler_table = &profiler_tables[0];
+
+static uint32_t profiler_sequence;
+static uint32_t profiler_jitter_state = 1;
+
+/* called from TIMER2_IRQHandler with the stacked exception frame:
+ * r0, r1, r2, r3, r12, lr, pc, xpsr */
+__attribute__((used)) void profiler_sample(uint32_t const *p_frame)
+{
+    profiler_table_t *p_table = p_profiler_table;
+    uint32_t key = p_frame[6] >> PROFILER_PC_SHIFT;
+    uint32_t slot = (key * 2654435761u) >> 16;
+    uint32_t x = profiler_jitter_state;
+    int i;
+
+    nrf_timer_event_clear(PROFILER_TIMER, NRF_TIMER_EVENT_COMPARE0);
+
+    /* xorshift, varies the next period */
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    profiler_jitter_state = x;
+
+    nrf_timer_cc_write(PROFILER_TIMER,
+                       NRF_TIMER_CC_CHANNEL0,
+                       profiler_timer_freq_hz / PROFILER_RATE_HZ + (x & profiler_jitter_mask));
+
+    p_table->samples++;
+
+#if STACK_USAGE_ENABLED
+    stack_usage_sample(p_frame);
+#endif
+
+    for (i = 0; i < profiler_max_probes; i++)
+    {
+        slot &= PROFILER_SLOTS - 1;
+
+        if (p_table->keys[slot] == key)
+        {
+            if (p_table->counts[slot] != UINT16_MAX)
+            {
+                p_table->counts[slot]++;
+            }
+            return;
+        }
+
+        if (p_table->keys[slot] == 0)
+        {
+            p_table->keys[slot] = key;
+            p_table->counts[slot] = 1;
+            return;
+        }
+
+        slot++;
+    }
+
+    p_table->lost++;
+}
+
+__attribute__((naked)) void TIMER2_IRQHandler(void)
+{
+    /* pass the frame of whichever stack the interrupted code was using and
+     * leave LR untouched, so profiler_sample() returns from the exception */
+    __asm volatile (
+        "tst lr, #4         \n"
+        "ite eq             \n"
+        "mrseq r0, msp      \n"
+        "mrsne r0, psp      \n"
+        "b profiler_sample  \n"
+    );
+}
+
+static void profiler_frame_send(profiler_frame_t *p_frame, uint32_t count)
+{
+    p_frame->count = count;
+
+    usb_aux_frame_send(USB_AUX_FRAME_PROFILE,
+                       p_frame,
+                       offsetof(profiler_frame_t, entries) + count * sizeof(profiler_entry_t));
+}
+
+static void profiler_report(void *ctx)
+{
+    profiler_table_t *p_table = p_profiler_table;
+    profiler_frame_t frame;
+    uint32_t count = 0;
+    bool sent = false;
+    uint32_t i;
+
+    p_profiler_table = (p_table == &profiler_tables[0]) ? &profiler_tables[1]
+                                                         : &profiler_tables[0];
+
+    frame.sequence = profiler_sequence++;
+    frame.samples = p_table->samples;
+    frame.lost = p_table->lost;
+    frame.pc_shift = PROFILER_PC_SHIFT;
+    frame.reserved = 0;
+
+    for (i = 0; i < PROFILER_SLOTS; i++)
+    {
+        if (p_table->keys[i] == 0)
+        {
+            continue;
+        }
+
+        frame.entries[count].bucket = p_table->keys[i];
+        frame.entries[count].samples = p_table->counts[i];
+
+        if (++count == profiler_frame_entries)
+        {
+            profiler_frame_send(&frame, count);
+            count = 0;
+            sent = true;
+        }
+    }
+
+    /* an empty table still reports its totals */
+    if (count != 0 || !sent)
+    {
+        profiler_frame_send(&frame, count);
+    }
+
+    memset(p_table, 0, sizeof(*p_table));
+}
+
+void profiler_init(void)
+{
+    nrf_timer_task_trigger(PROFILER_TIMER, NRF_TIMER_TASK_STOP);
+    nrf_timer_mode_set(PROFILER_TIMER, NRF_TIMER_MODE_TIMER);
+    nrf_timer_bit_width_set(PROFILER_TIMER, NRF_TIMER_BIT_WIDTH_32);
+    nrf_timer_frequency_set(PROFILER_TIMER, NRF_TIMER_FREQ_1MHz);
+    nrf_timer_cc_write(PROFILER_TIMER,
+                       NRF_TIMER_CC_CHANNEL0,
+                       profiler_timer_freq_hz / PROFILER_RATE_HZ);
+    nrf_timer_shorts_enable(PROFILER_TIMER, NRF_TIMER_SHORT_COMPARE0_CLEAR_MASK);
+    nrf_timer_int_enable(PROFILER_TIMER, NRF_TIMER_INT_COMPARE0_MASK);
+
+    NRFX_IRQ_PRIORITY_SET(TIMER2_IRQn, IRQ_PRIO_PROFILER);
+    NRFX_IRQ_ENABLE(TIMER2_IRQn);
+
+    nrf_timer_task_trigger(PROFILER_TIMER, NRF_TIMER_TASK_CLEAR);
+    nrf_timer_task_trigger(PROFILER_TIMER, NRF_TIMER_TASK_START);
+
+    app_timer_create(&profiler_report_timer, APP_TIMER_MODE_REPEATED, profiler_report);
+    app_timer_start(profiler_report_timer, APP_TIMER_TICKS(PROFILER_REPORT_MS), NULL);
+}
+
+#endif
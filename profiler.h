@@ -0,0 +1,29 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "sdk_config.h"
+
+/* Sampling PC profiler.
+ *
+ * TIMER2 interrupts PROFILER_RATE_HZ times a second, with a few
+ * microseconds of jitter so it cannot lock onto periodic activity, at a
+ * priority above everything else in the application. Its handler reads the
+ * PC from the stacked exception frame and counts it in a small hash table of
+ * PC >> PROFILER_PC_SHIFT buckets. Samples taken while the core sleeps land
+ * on the WFE in idle.c.
+ *
+ * Every PROFILER_REPORT_MS the table is swapped with a spare one and sent
+ * over the auxiliary USB port as
+ *
+ *     USB_AUX_FRAME_PROFILE: sequence (u32) | samples (u32) | lost (u32) |
+ *                            PC shift (u8) | 0 | count (u16) |
+ *                            count * { bucket (u32), samples (u32) }
+ *
+ * split over several frames with the same sequence when the table holds
+ * more buckets than fit in one. A bucket covers the addresses
+ * bucket << shift up to the next bucket. Lost samples found no free slot.
+ * tools/aux_profile.py turns the stream into a flat per-function profile. */
+
+void profiler_init(void);
+
+#endif
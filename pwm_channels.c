@@ -0,0 +1,257 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pwm_channels.h"
+
+#if PWM_CHANNELS_ENABLED
+
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "irq_priorities.h"
+#include "nrfx_pwm.h"
+
+#define NRF_LOG_MODULE_NAME pwm_channels
+#define NRF_LOG_LEVEL PWM_CHANNELS_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+/* duty values with bit 15 set, as in the fixed duty table */
+enum { pwm_channels_polarity = 0x8000 };
+
+enum { pwm_channels_per_instance = NRF_PWM_CHANNEL_COUNT };
+
+enum { pwm_channels_max_instances = 4 };
+
+STATIC_ASSERT((PWM_CHANNELS_INSTANCES & ~0x0f) == 0);
+
+typedef struct {
+    nrfx_pwm_t pwm;
+    nrf_pwm_values_individual_t buffers[2];     /* read by EasyDMA */
+    nrf_pwm_sequence_t sequences[2];
+    nrf_pwm_values_individual_t shadow;         /* pwm_channels_set() */
+    nrf_pwm_values_individual_t committed;      /* pwm_channels_commit() */
+    volatile uint8_t stale;     /* buffers still to receive the committed values */
+    bool dirty;
+    bool active;
+} pwm_channels_instance_t;
+
+static pwm_channels_instance_t pwm_channels_instances[pwm_channels_max_instances] = {
+    { .pwm = NRFX_PWM_INSTANCE(0) },
+    { .pwm = NRFX_PWM_INSTANCE(1) },
+    { .pwm = NRFX_PWM_INSTANCE(2) },
+    { .pwm = NRFX_PWM_INSTANCE(3) },
+};
+
+/* channel n lives in pwm_channels_map[n / 4], output n % 4 */
+static pwm_channels_instance_t *pwm_channels_map[pwm_channels_max_instances];
+static uint32_t pwm_channels_total;
+
+static uint16_t *pwm_channels_value(nrf_pwm_values_individual_t *p_values, uint32_t output)
+{
+    /* the four channel fields are consecutive */
+    return &p_values->channel_0 + output;
+}
+
+static void pwm_channels_evt(pwm_channels_instance_t *p_inst, nrfx_pwm_evt_type_t evt)
+{
+    uint8_t idle;
+
+    if (evt == NRFX_PWM_EVT_END_SEQ0)
+    {
+        idle = 0;
+    }
+    else if (evt == NRFX_PWM_EVT_END_SEQ1)
+    {
+        idle = 1;
+    }
+    else
+    {
+        return;
+    }
+
+    if (p_inst->stale & (1 << idle))
+    {
+        p_inst->buffers[idle] = p_inst->committed;
+        p_inst->stale &= ~(1 << idle);
+    }
+
+    if (p_inst->stale == 0)
+    {
+        nrf_pwm_int_disable(p_inst->pwm.p_registers,
+                            NRF_PWM_INT_SEQEND0_MASK | NRF_PWM_INT_SEQEND1_MASK);
+    }
+}
+
+/* nrfx passes no context to the handlers */
+static void pwm_channels_evt_0(nrfx_pwm_evt_type_t evt)
+{
+    pwm_channels_evt(&pwm_channels_instances[0], evt);
+}
+
+static void pwm_channels_evt_1(nrfx_pwm_evt_type_t evt)
+{
+    pwm_channels_evt(&pwm_channels_instances[1], evt);
+}
+
+static void pwm_channels_evt_2(nrfx_pwm_evt_type_t evt)
+{
+    pwm_channels_evt(&pwm_channels_instances[2], evt);
+}
+
+static void pwm_channels_evt_3(nrfx_pwm_evt_type_t evt)
+{
+    pwm_channels_evt(&pwm_channels_instances[3], evt);
+}
+
+static nrfx_pwm_handler_t const pwm_channels_handlers[pwm_channels_max_instances] = {
+    pwm_channels_evt_0,
+    pwm_channels_evt_1,
+    pwm_channels_evt_2,
+    pwm_channels_evt_3,
+};
+
+static bool pwm_channels_start(uint32_t index, uint8_t const *p_pins, uint32_t count)
+{
+    pwm_channels_instance_t *p_inst = &pwm_channels_instances[index];
+    nrfx_pwm_config_t config;
+    nrfx_err_t err;
+    uint32_t i;
+
+    for (i = 0; i < pwm_channels_per_instance; i++)
+    {
+        config.output_pins[i] = (i < count) ? p_pins[i] : NRFX_PWM_PIN_NOT_USED;
+        *pwm_channels_value(&p_inst->shadow, i) = pwm_channels_polarity;
+    }
+
+    config.irq_priority = IRQ_PRIO_PWM_CHANNELS;
+    config.base_clock = PWM_CHANNELS_BASE_CLOCK;
+    config.count_mode = NRF_PWM_MODE_UP;
+    config.top_value = PWM_CHANNELS_TOP_VALUE;
+    config.load_mode = NRF_PWM_LOAD_INDIVIDUAL;
+    config.step_mode = NRF_PWM_STEP_AUTO;
+
+    err = nrfx_pwm_init(&p_inst->pwm, &config, pwm_channels_handlers[index]);
+
+    if (err != NRFX_SUCCESS)
+    {
+        NRF_LOG_ERROR("PWM%u init failed: 0x%x", index, err);
+        return false;
+    }
+
+    p_inst->committed = p_inst->shadow;
+
+    for (i = 0; i < 2; i++)
+    {
+        p_inst->buffers[i] = p_inst->shadow;
+
+        p_inst->sequences[i].values.p_individual = &p_inst->buffers[i];
+        p_inst->sequences[i].length = NRF_PWM_VALUES_LENGTH(p_inst->buffers[i]);
+        p_inst->sequences[i].repeats = 0;
+        p_inst->sequences[i].end_delay = 0;
+    }
+
+    /* the SEQEND interrupts are turned on by pwm_channels_commit() */
+    nrfx_pwm_complex_playback(&p_inst->pwm,
+                              &p_inst->sequences[0],
+                              &p_inst->sequences[1],
+                              1,
+                              NRFX_PWM_FLAG_LOOP
+                              | NRFX_PWM_FLAG_NO_EVT_FINISHED
+                              | NRFX_PWM_FLAG_SIGNAL_END_SEQ0
+                              | NRFX_PWM_FLAG_SIGNAL_END_SEQ1);
+
+    nrf_pwm_int_disable(p_inst->pwm.p_registers,
+                        NRF_PWM_INT_SEQEND0_MASK | NRF_PWM_INT_SEQEND1_MASK);
+
+    p_inst->active = true;
+
+    return true;
+}
+
+void pwm_channels_init(uint8_t const *p_pins, uint32_t count)
+{
+    uint32_t index;
+    uint32_t n;
+
+    pwm_channels_total = 0;
+
+    for (index = 0; index < pwm_channels_max_instances && pwm_channels_total < count; index++)
+    {
+        if (!(PWM_CHANNELS_INSTANCES & (1 << index)))
+        {
+            continue;
+        }
+
+        n = MIN(count - pwm_channels_total, pwm_channels_per_instance);
+
+        if (!pwm_channels_start(index, &p_pins[pwm_channels_total], n))
+        {
+            break;
+        }
+
+        pwm_channels_map[pwm_channels_total / pwm_channels_per_instance] =
+            &pwm_channels_instances[index];
+        pwm_channels_total += n;
+    }
+
+    if (pwm_channels_total < count)
+    {
+        NRF_LOG_WARNING("%u of %u channels available", pwm_channels_total, count);
+    }
+}
+
+uint32_t pwm_channels_count(void)
+{
+    return pwm_channels_total;
+}
+
+void pwm_channels_set(uint32_t channel, uint16_t duty)
+{
+    pwm_channels_instance_t *p_inst;
+
+    if (channel >= pwm_channels_total)
+    {
+        return;
+    }
+
+    p_inst = pwm_channels_map[channel / pwm_channels_per_instance];
+
+    *pwm_channels_value(&p_inst->shadow, channel % pwm_channels_per_instance) =
+        MIN(duty, PWM_CHANNELS_TOP_VALUE) | pwm_channels_polarity;
+    p_inst->dirty = true;
+}
+
+void pwm_channels_commit(void)
+{
+    pwm_channels_instance_t *p_inst;
+    NRF_PWM_Type *p_reg;
+    uint32_t i;
+
+    for (i = 0; i < pwm_channels_max_instances; i++)
+    {
+        p_inst = &pwm_channels_instances[i];
+
+        if (!p_inst->active || !p_inst->dirty)
+        {
+            continue;
+        }
+
+        p_reg = p_inst->pwm.p_registers;
+
+        CRITICAL_REGION_ENTER();
+
+        p_inst->committed = p_inst->shadow;
+        p_inst->stale = 0x03;
+        p_inst->dirty = false;
+
+        /* old events do not tell which slot is playing now, only the next
+         * SEQEND does */
+        nrf_pwm_event_clear(p_reg, NRF_PWM_EVENT_SEQEND0);
+        nrf_pwm_event_clear(p_reg, NRF_PWM_EVENT_SEQEND1);
+        nrf_pwm_int_enable(p_reg, NRF_PWM_INT_SEQEND0_MASK | NRF_PWM_INT_SEQEND1_MASK);
+
+        CRITICAL_REGION_EXIT();
+    }
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef PWM_CHANNELS_H
+#define PWM_CHANNELS_H
+
+#include <stdint.h>
+
+#include "sdk_config.h"
+
+/* PWM dimming channels.
+ *
+ * Every PWM instance in PWM_CHANNELS_INSTANCES drives four independent
+ * channels with individual load, for up to 16 channels. Each instance
+ * loops two one-step sequences, one in each sequence slot, so the value
+ * buffer of one slot is idle while the other plays.
+ *
+ * pwm_channels_set() only records a duty cycle. pwm_channels_commit()
+ * hands all recorded changes to the instances at once; each of them then
+ * copies the new values into the idle buffer on its next two SEQEND events
+ * and turns the events off again. A change therefore starts exactly at a
+ * period boundary, all channels of an instance switch in the same period,
+ * and the CPU is only involved while a change is in flight. */
+
+#if PWM_CHANNELS_ENABLED
+
+/* pins in channel order, four per instance in PWM_CHANNELS_INSTANCES
+ * order; count is at most 4 per instance */
+void pwm_channels_init(uint8_t const *p_pins, uint32_t count);
+
+uint32_t pwm_channels_count(void);
+
+/* duty cycle from 0 to PWM_CHANNELS_TOP_VALUE, effective after the next
+ * pwm_channels_commit() */
+void pwm_channels_set(uint32_t channel, uint16_t duty);
+
+void pwm_channels_commit(void);
+
+#endif
+
+#endif
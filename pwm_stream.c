@@ -0,0 +1,73 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "pwm_stream.h"
+
+#include "metrics.h"
+
+static nrf_pwm_sequence_t pwm_stream_sequences[2];
+
+static uint16_t *p_pwm_stream_values;
+static uint16_t pwm_stream_length;
+static pwm_stream_fill_t pwm_stream_fill;
+
+METRIC_DEF(pwm_stream_refills, METRIC_COUNTER);
+
+void pwm_stream_start(nrfx_pwm_t const *p_pwm,
+                      uint16_t *p_values,
+                      uint16_t length,
+                      uint16_t repeats,
+                      pwm_stream_fill_t fill)
+{
+    int i;
+
+    p_pwm_stream_values = p_values;
+    pwm_stream_length = length;
+    pwm_stream_fill = fill;
+
+    for (i = 0; i < 2; i++)
+    {
+        pwm_stream_sequences[i].values.p_common = &p_values[i * length];
+        pwm_stream_sequences[i].length = length;
+        pwm_stream_sequences[i].repeats = repeats;
+        pwm_stream_sequences[i].end_delay = 0;
+
+        fill(&p_values[i * length], length);
+    }
+
+    nrfx_pwm_complex_playback(p_pwm,
+                              &pwm_stream_sequences[0],
+                              &pwm_stream_sequences[1],
+                              1,
+                              NRFX_PWM_FLAG_LOOP
+                              | NRFX_PWM_FLAG_SIGNAL_END_SEQ0
+                              | NRFX_PWM_FLAG_SIGNAL_END_SEQ1);
+}
+
+void pwm_stream_evt_handler(nrfx_pwm_evt_type_t evt)
+{
+    uint32_t idle;
+
+    /* the buffer that just ended is idle until the other one ends */
+    if (evt == NRFX_PWM_EVT_END_SEQ0)
+    {
+        idle = 0;
+    }
+    else if (evt == NRFX_PWM_EVT_END_SEQ1)
+    {
+        idle = 1;
+    }
+    else
+    {
+        return;
+    }
+
+    if (pwm_stream_fill == NULL)
+    {
+        return;
+    }
+
+    pwm_stream_fill(&p_pwm_stream_values[idle * pwm_stream_length], pwm_stream_length);
+
+    METRIC_INC(pwm_stream_refills);
+}
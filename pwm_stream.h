@@ -0,0 +1,31 @@
+#ifndef PWM_STREAM_H
+#define PWM_STREAM_H
+
+#include <stdint.h>
+
+#include "nrfx_pwm.h"
+
+/* Streaming PWM playback.
+ *
+ * Two sequences of common-load values play back to back in a loop through
+ * nrfx_pwm_complex_playback(). When one of them ends, the fill callback
+ * refills it from the PWM interrupt while the other one plays, so each
+ * fill has one sequence of playback time to complete. There is one stream,
+ * fed by whichever module owns PWM0. */
+
+/* writes length values for the buffer that is about to be played */
+typedef void (*pwm_stream_fill_t)(uint16_t *p_values, uint16_t length);
+
+/* p_pwm must be initialized with common load and automatic steps, and its
+ * handler must pass the events on to pwm_stream_evt_handler(). p_values
+ * holds two buffers of length values each; every value is played for
+ * repeats + 1 PWM periods. */
+void pwm_stream_start(nrfx_pwm_t const *p_pwm,
+                      uint16_t *p_values,
+                      uint16_t length,
+                      uint16_t repeats,
+                      pwm_stream_fill_t fill);
+
+void pwm_stream_evt_handler(nrfx_pwm_evt_type_t evt);
+
+#endif
@@ -0,0 +1,129 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "pwm_swap.h"
+
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "metrics.h"
+
+enum {
+    pwm_swap_idle,
+    pwm_swap_requested,     /* waiting for a SEQEND to switch the slots */
+    pwm_swap_retiring       /* the old table plays one last time */
+};
+
+static nrfx_pwm_t const *p_pwm_swap_pwm;
+
+static uint16_t pwm_swap_buffers[2][pwm_swap_max_length];   /* read by EasyDMA */
+static nrf_pwm_sequence_t pwm_swap_sequences[2];
+
+/* the buffer both slots play */
+static uint8_t pwm_swap_live;
+
+static volatile uint8_t pwm_swap_state;
+
+/* SEQEND interrupts the caller asked for */
+static uint32_t pwm_swap_int_mask;
+
+METRIC_DEF(pwm_swap_installs, METRIC_COUNTER);
+
+static void pwm_swap_load(uint8_t buffer,
+                          uint16_t const *p_values,
+                          uint16_t length,
+                          uint16_t repeats)
+{
+    memcpy(pwm_swap_buffers[buffer], p_values, length * sizeof(p_values[0]));
+
+    pwm_swap_sequences[buffer].values.p_common = pwm_swap_buffers[buffer];
+    pwm_swap_sequences[buffer].length = length;
+    pwm_swap_sequences[buffer].repeats = repeats;
+    pwm_swap_sequences[buffer].end_delay = 0;
+}
+
+void pwm_swap_start(nrfx_pwm_t const *p_pwm,
+                    uint16_t const *p_values,
+                    uint16_t length,
+                    uint16_t repeats,
+                    uint32_t flags)
+{
+    p_pwm_swap_pwm = p_pwm;
+    pwm_swap_live = 0;
+    pwm_swap_state = pwm_swap_idle;
+
+    pwm_swap_int_mask = ((flags & NRFX_PWM_FLAG_SIGNAL_END_SEQ0) ? NRF_PWM_INT_SEQEND0_MASK : 0)
+                        | ((flags & NRFX_PWM_FLAG_SIGNAL_END_SEQ1) ? NRF_PWM_INT_SEQEND1_MASK : 0);
+
+    pwm_swap_load(0, p_values, MIN(length, pwm_swap_max_length), repeats);
+
+    /* the SEQEND interrupts are turned on by pwm_swap_install() */
+    nrfx_pwm_complex_playback(p_pwm,
+                              &pwm_swap_sequences[0],
+                              &pwm_swap_sequences[0],
+                              1,
+                              flags
+                              | NRFX_PWM_FLAG_LOOP
+                              | NRFX_PWM_FLAG_NO_EVT_FINISHED
+                              | NRFX_PWM_FLAG_SIGNAL_END_SEQ0
+                              | NRFX_PWM_FLAG_SIGNAL_END_SEQ1);
+
+    nrf_pwm_int_disable(p_pwm->p_registers,
+                        (NRF_PWM_INT_SEQEND0_MASK | NRF_PWM_INT_SEQEND1_MASK) & ~pwm_swap_int_mask);
+}
+
+bool pwm_swap_install(uint16_t const *p_values, uint16_t length, uint16_t repeats)
+{
+    NRF_PWM_Type *p_reg = p_pwm_swap_pwm->p_registers;
+
+    if (length == 0 || length > pwm_swap_max_length || pwm_swap_state != pwm_swap_idle)
+    {
+        return false;
+    }
+
+    /* neither slot points at the other buffer while idle */
+    pwm_swap_load(pwm_swap_live ^ 1, p_values, length, repeats);
+
+    CRITICAL_REGION_ENTER();
+
+    pwm_swap_state = pwm_swap_requested;
+
+    /* only a SEQEND that comes after this tells that a slot just started */
+    nrf_pwm_event_clear(p_reg, NRF_PWM_EVENT_SEQEND0);
+    nrf_pwm_event_clear(p_reg, NRF_PWM_EVENT_SEQEND1);
+    nrf_pwm_int_enable(p_reg, NRF_PWM_INT_SEQEND0_MASK | NRF_PWM_INT_SEQEND1_MASK);
+
+    CRITICAL_REGION_EXIT();
+
+    METRIC_INC(pwm_swap_installs);
+
+    return true;
+}
+
+void pwm_swap_evt_handler(nrfx_pwm_evt_type_t evt)
+{
+    NRF_PWM_Type *p_reg = p_pwm_swap_pwm->p_registers;
+
+    if (evt != NRFX_PWM_EVT_END_SEQ0 && evt != NRFX_PWM_EVT_END_SEQ1)
+    {
+        return;
+    }
+
+    if (pwm_swap_state == pwm_swap_requested)
+    {
+        /* the slot that ended starts again only after the other one, which
+         * has just loaded its pointer; both are free to change */
+        nrf_pwm_sequence_set(p_reg, 0, &pwm_swap_sequences[pwm_swap_live ^ 1]);
+        nrf_pwm_sequence_set(p_reg, 1, &pwm_swap_sequences[pwm_swap_live ^ 1]);
+
+        pwm_swap_state = pwm_swap_retiring;
+    }
+    else if (pwm_swap_state == pwm_swap_retiring)
+    {
+        pwm_swap_live ^= 1;
+        pwm_swap_state = pwm_swap_idle;
+
+        nrf_pwm_int_disable(p_reg,
+                            (NRF_PWM_INT_SEQEND0_MASK | NRF_PWM_INT_SEQEND1_MASK) & ~pwm_swap_int_mask);
+    }
+}
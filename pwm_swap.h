@@ -0,0 +1,43 @@
+#ifndef PWM_SWAP_H
+#define PWM_SWAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "nrfx_pwm.h"
+
+/* Looped duty table that can be replaced while it plays.
+ *
+ * The table plays from both sequence slots in a loop. pwm_swap_install()
+ * copies the new table into the buffer that is not playing and turns on
+ * the SEQEND interrupts. At the first SEQEND one slot has just started
+ * and the other one starts only when that one ends, so both slots are
+ * pointed at the new buffer right there: the sequence that is starting
+ * finishes the old table, the new one follows at the next boundary.
+ * Sequences only change at period boundaries, so no period is cut short.
+ * The old buffer is released at the following SEQEND.
+ *
+ * The handler has one sequence of playback time to run, length * (repeats
+ * + 1) PWM periods. Should it be later than that, both SEQENDs are handled
+ * at once and the buffer still playing is released, so short tables at high
+ * PWM frequencies need repeats. */
+
+enum { pwm_swap_max_length = 64 };
+
+/* p_pwm must be initialized with common load and automatic steps, and its
+ * handler must pass the events on to pwm_swap_evt_handler(). Every value
+ * is played for repeats + 1 PWM periods. flags may ask for the SEQEND
+ * events the caller needs itself. */
+void pwm_swap_start(nrfx_pwm_t const *p_pwm,
+                    uint16_t const *p_values,
+                    uint16_t length,
+                    uint16_t repeats,
+                    uint32_t flags);
+
+/* false while the previous table is still being replaced; p_values can be
+ * reused as soon as this returns */
+bool pwm_swap_install(uint16_t const *p_values, uint16_t length, uint16_t repeats);
+
+void pwm_swap_evt_handler(nrfx_pwm_evt_type_t evt);
+
+#endif
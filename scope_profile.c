@@ -0,0 +1,85 @@
+#include <stdint.h>
+
+#include "scope_profile.h"
+
+#if SCOPE_PROFILE_ENABLED
+
+#include "app_timer.h"
+#include "nrf.h"
+
+#define NRF_LOG_MODULE_NAME scope_profile
+#define NRF_LOG_LEVEL SCOPE_PROFILE_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+NRF_SECTION_DEF(scope_profiles, scope_profile_t const);
+
+APP_TIMER_DEF(scope_profile_report_timer);
+
+void scope_profile_add(scope_profile_stats_t *p_stats, uint32_t cycles)
+{
+    uint32_t primask;
+
+    /* scopes like max7219_write run from thread and interrupt context */
+    primask = __get_PRIMASK();
+    __disable_irq();
+
+    p_stats->cycles += cycles;
+    p_stats->calls++;
+
+    if (cycles > p_stats->max)
+    {
+        p_stats->max = cycles;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+void scope_profile_log(void)
+{
+    uint32_t count = NRF_SECTION_ITEM_COUNT(scope_profiles, scope_profile_t const);
+    uint32_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        scope_profile_t const *p_scope =
+            NRF_SECTION_ITEM_GET(scope_profiles, scope_profile_t const, i);
+        scope_profile_stats_t stats;
+        uint32_t primask;
+
+        primask = __get_PRIMASK();
+        __disable_irq();
+        stats = *p_scope->p_stats;
+        __set_PRIMASK(primask);
+
+        NRF_LOG_INFO("%s: calls %u, avg %u, max %u cycles",
+                     p_scope->p_name,
+                     stats.calls,
+                     stats.calls ? (uint32_t)(stats.cycles / stats.calls) : 0,
+                     stats.max);
+    }
+}
+
+static void scope_profile_report(void *ctx)
+{
+    scope_profile_log();
+}
+
+void scope_profile_init(void)
+{
+    cycle_counter_init();
+
+    if (SCOPE_PROFILE_REPORT_PERIOD_MS == 0)
+    {
+        return;
+    }
+
+    app_timer_create(&scope_profile_report_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     scope_profile_report);
+    app_timer_start(scope_profile_report_timer,
+                    APP_TIMER_TICKS(SCOPE_PROFILE_REPORT_PERIOD_MS),
+                    NULL);
+}
+
+#endif
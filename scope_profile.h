@@ -0,0 +1,72 @@
+#ifndef SCOPE_PROFILE_H
+#define SCOPE_PROFILE_H
+
+#include <stdint.h>
+
+#include "sdk_config.h"
+
+/* Named-scope cycle profiler.
+ *
+ * SCOPE_PROFILE_DEF(name) creates a statistics entry and registers it in the
+ * .scope_profiles section. SCOPE_PROFILE_BEGIN(name) and
+ * SCOPE_PROFILE_END(name), in the same block, read the DWT cycle counter and
+ * add the elapsed cycles, the call and the maximum to the entry.
+ * scope_profile_log() dumps every entry through NRF_LOG, and so does a
+ * report timer every SCOPE_PROFILE_REPORT_PERIOD_MS.
+ *
+ * The counter stops while the core sleeps, and a scope that is preempted
+ * includes the time of the preempting interrupts. With
+ * SCOPE_PROFILE_ENABLED 0 all of it compiles to nothing. */
+
+#if SCOPE_PROFILE_ENABLED
+
+#include "cycle_counter.h"
+#include "nrf_section.h"
+
+typedef struct {
+    uint64_t cycles;
+    uint32_t calls;
+    uint32_t max;
+} scope_profile_stats_t;
+
+typedef struct {
+    char const *p_name;
+    scope_profile_stats_t *p_stats;
+} scope_profile_t;
+
+#define SCOPE_PROFILE_DEF(_name)                                             \
+    static scope_profile_stats_t _name##_scope_stats;                        \
+    NRF_SECTION_ITEM_REGISTER(scope_profiles,                                \
+                              static scope_profile_t const                   \
+                              _name##_scope_profile) = {                     \
+        .p_name = #_name,                                                    \
+        .p_stats = &_name##_scope_stats                                      \
+    }
+
+#define SCOPE_PROFILE_BEGIN(_name)                                           \
+    uint32_t _name##_scope_start = cycle_counter_get()
+
+#define SCOPE_PROFILE_END(_name)                                             \
+    scope_profile_add(&_name##_scope_stats,                                  \
+                      cycle_counter_get() - _name##_scope_start)
+
+void scope_profile_add(scope_profile_stats_t *p_stats, uint32_t cycles);
+
+void scope_profile_init(void);
+
+void scope_profile_log(void);
+
+#else
+
+#define SCOPE_PROFILE_DEF(_name) extern int scope_profile_disabled
+#define SCOPE_PROFILE_BEGIN(_name) do { } while (0)
+#define SCOPE_PROFILE_END(_name) do { } while (0)
+
+static inline void scope_profile_log(void)
+{
+
+}
+
+#endif
+
+#endif
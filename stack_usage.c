@@ -0,0 +1,164 @@
+#include <stdint.h>
+
+#include "stack_usage.h"
+
+#if STACK_USAGE_ENABLED
+
+#include "app_timer.h"
+#include "metrics.h"
+#include "nrf.h"
+
+#define NRF_LOG_MODULE_NAME stack_usage
+#define NRF_LOG_LEVEL STACK_USAGE_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+/* defined by the linker script */
+extern uint32_t __StackTop;
+extern uint32_t __StackLimit;
+
+enum { stack_usage_pattern = 0x5ca1ab1e };
+
+/* system exceptions followed by the peripheral interrupts */
+enum { stack_usage_exceptions = 16 + SPIM3_IRQn + 1 };
+
+/* the MPU region of the stack guard must be neither painted nor read */
+#if NRF_STACK_GUARD_ENABLED
+enum { stack_usage_guard_bytes = 1 << NRF_STACK_GUARD_CONFIG_SIZE };
+#else
+enum { stack_usage_guard_bytes = 0 };
+#endif
+
+static nrf_atomic_u32_t stack_usage_peaks[stack_usage_exceptions];
+
+METRIC_DEF(stack_high_water, METRIC_GAUGE);
+
+APP_TIMER_DEF(stack_usage_report_timer);
+
+static uint32_t *stack_usage_bottom(void)
+{
+    return (uint32_t *)((uint8_t *)&__StackLimit + stack_usage_guard_bytes);
+}
+
+static uint32_t stack_usage_depth(uint32_t sp)
+{
+    return (uint32_t)&__StackTop - sp;
+}
+
+void stack_usage_paint(void)
+{
+    volatile uint32_t *p_word = stack_usage_bottom();
+    uint32_t *p_sp = (uint32_t *)__get_MSP();
+
+    /* nothing lives below the stack pointer yet, no interrupt is enabled */
+    while (p_word < p_sp)
+    {
+        *p_word++ = stack_usage_pattern;
+    }
+}
+
+uint32_t stack_usage_high_water(void)
+{
+    uint32_t const *p_word = stack_usage_bottom();
+    uint32_t const *p_top = &__StackTop;
+
+    while (p_word < p_top && *p_word == stack_usage_pattern)
+    {
+        p_word++;
+    }
+
+    return stack_usage_depth((uint32_t)p_word);
+}
+
+uint32_t stack_usage_size(void)
+{
+    return stack_usage_depth((uint32_t)stack_usage_bottom());
+}
+
+void stack_usage_mark(void)
+{
+    uint32_t exception = __get_IPSR();
+
+    if (exception < stack_usage_exceptions)
+    {
+        metrics_peak_update(&stack_usage_peaks[exception],
+                            stack_usage_depth(__get_MSP()));
+    }
+}
+
+void stack_usage_sample(uint32_t const *p_frame)
+{
+    /* the stacked xPSR holds the exception number of the interrupted context */
+    uint32_t exception = p_frame[7] & IPSR_ISR_Msk;
+    uint32_t sp = (uint32_t)p_frame;
+
+    /* frames on the process stack are not ours to measure */
+    if (sp < (uint32_t)&__StackLimit || sp > (uint32_t)&__StackTop)
+    {
+        return;
+    }
+
+    if (exception < stack_usage_exceptions)
+    {
+        metrics_peak_update(&stack_usage_peaks[exception], stack_usage_depth(sp));
+    }
+}
+
+void stack_usage_log(void)
+{
+    uint32_t size = stack_usage_size();
+    uint32_t used = stack_usage_high_water();
+    uint32_t peak;
+    uint32_t i;
+
+    METRIC_SET(stack_high_water, used);
+
+    NRF_LOG_INFO("stack: %u of %u bytes used, %u free", used, size, size - used);
+
+    for (i = 0; i < stack_usage_exceptions; i++)
+    {
+        peak = stack_usage_peaks[i];
+
+        if (peak == 0)
+        {
+            continue;
+        }
+
+        if (i == 0)
+        {
+            NRF_LOG_INFO("  thread: peak %u bytes", peak);
+        }
+        else if (i < 16)
+        {
+            NRF_LOG_INFO("  exception %u: peak %u bytes", i, peak);
+        }
+        else
+        {
+            NRF_LOG_INFO("  IRQ %u: peak %u bytes", i - 16, peak);
+        }
+    }
+}
+
+static void stack_usage_report(void *ctx)
+{
+    stack_usage_log();
+}
+
+void stack_usage_init(void)
+{
+    METRIC_SET(stack_high_water, stack_usage_high_water());
+
+    if (STACK_USAGE_REPORT_PERIOD_MS == 0)
+    {
+        return;
+    }
+
+    app_timer_create(&stack_usage_report_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     stack_usage_report);
+    app_timer_start(stack_usage_report_timer,
+                    APP_TIMER_TICKS(STACK_USAGE_REPORT_PERIOD_MS),
+                    NULL);
+}
+
+#endif
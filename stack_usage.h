@@ -0,0 +1,53 @@
+#ifndef STACK_USAGE_H
+#define STACK_USAGE_H
+
+#include <stdint.h>
+
+#include "sdk_config.h"
+
+/* Main stack usage.
+ *
+ * stack_usage_paint(), called first thing in main(), fills the unused part
+ * of the stack with a known pattern. stack_usage_high_water() finds the
+ * lowest word that was overwritten since, so it returns the deepest the
+ * stack has ever been, including the interrupts that nested on top of
+ * everything else.
+ *
+ * Peak depths are also kept per exception number. STACK_USAGE_MARK() in a
+ * handler records the depth at that point, which at entry is the depth of
+ * the preempted contexts. With PROFILER_ENABLED every PC sample records the
+ * depth of the interrupted context as well, which over time catches handlers
+ * at their deepest.
+ *
+ * The high-water mark and the per-exception peaks are logged every
+ * STACK_USAGE_REPORT_PERIOD_MS, and the high-water mark is kept in the
+ * stack_high_water metric. */
+
+#if STACK_USAGE_ENABLED
+
+void stack_usage_paint(void);
+
+void stack_usage_init(void);
+
+/* deepest stack use since boot, in bytes */
+uint32_t stack_usage_high_water(void);
+
+/* stack size available to the application, in bytes */
+uint32_t stack_usage_size(void);
+
+void stack_usage_mark(void);
+
+/* p_frame is the exception frame stacked by the interrupted context */
+void stack_usage_sample(uint32_t const *p_frame);
+
+void stack_usage_log(void);
+
+#define STACK_USAGE_MARK() stack_usage_mark()
+
+#else
+
+#define STACK_USAGE_MARK() do { } while (0)
+
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef APP_TIMER_H
+#define APP_TIMER_H
+
+#include <stdint.h>
+
+/* the RTC counter is 24 bits wide, the test advances it by hand */
+extern uint32_t test_app_timer_cnt;
+
+#define APP_TIMER_CLOCK_FREQ 32768
+#define APP_TIMER_CONFIG_RTC_FREQUENCY 0
+#define APP_TIMER_MAX_CNT_VAL 0x00ffffff
+
+#define APP_TIMER_TICKS(ms)                                                  \
+    ((uint32_t)(((uint64_t)(ms) * APP_TIMER_CLOCK_FREQ + 500)                \
+                / (1000 * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1))))
+
+static inline uint32_t app_timer_cnt_get(void)
+{
+    return test_app_timer_cnt & APP_TIMER_MAX_CNT_VAL;
+}
+
+static inline uint32_t app_timer_cnt_diff_compute(uint32_t ticks_to, uint32_t ticks_from)
+{
+    return (ticks_to - ticks_from) & APP_TIMER_MAX_CNT_VAL;
+}
+
+#endif
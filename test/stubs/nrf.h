@@ -0,0 +1,29 @@
+#ifndef NRF_H
+#define NRF_H
+
+#include <stdint.h>
+
+typedef enum {
+    RTC1_IRQn = 17,
+    RTC2_IRQn = 36,
+} IRQn_Type;
+
+typedef struct {
+    uint32_t inten;
+    uint32_t prescaler;
+    uint32_t events_compare[4];
+    uint32_t cc[4];
+} NRF_RTC_Type;
+
+/* both RTCs count test_app_timer_cnt, only their compares are their own */
+extern NRF_RTC_Type test_rtc1;
+extern NRF_RTC_Type test_rtc2;
+
+#define NRF_RTC1 (&test_rtc1)
+#define NRF_RTC2 (&test_rtc2)
+
+/* provided by the test, which decides how long the core sleeps */
+void __WFE(void);
+void __SEV(void);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef NRF_ATOMIC_H
+#define NRF_ATOMIC_H
+
+#include <stdint.h>
+
+/* the tests run single-threaded, interrupts are plain calls */
+typedef volatile uint32_t nrf_atomic_u32_t;
+
+static inline uint32_t nrf_atomic_u32_or(nrf_atomic_u32_t *p_data, uint32_t value)
+{
+    *p_data |= value;
+    return *p_data;
+}
+
+static inline uint32_t nrf_atomic_u32_fetch_store(nrf_atomic_u32_t *p_data, uint32_t value)
+{
+    uint32_t old = *p_data;
+
+    *p_data = value;
+    return old;
+}
+
+#endif
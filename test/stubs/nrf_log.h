@@ -0,0 +1,19 @@
+#ifndef NRF_LOG_H
+#define NRF_LOG_H
+
+#include <stdio.h>
+
+/* the tests print their own results; like the disabled frontend the entries
+ * are compiled and checked but go nowhere */
+
+#define NRF_LOG_MODULE_REGISTER() extern int test_nrf_log_module
+
+#define NRF_LOG_INFO(...)                                                    \
+    do {                                                                     \
+        if (0)                                                               \
+        {                                                                    \
+            printf(__VA_ARGS__);                                             \
+        }                                                                    \
+    } while (0)
+
+#endif
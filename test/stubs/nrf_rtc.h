@@ -0,0 +1,64 @@
+#ifndef NRF_RTC_H
+#define NRF_RTC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "app_timer.h"
+#include "nrf.h"
+
+#define NRF_RTC_INT_COMPARE0_MASK (1u << 16)
+
+typedef enum {
+    NRF_RTC_EVENT_COMPARE_0,
+} nrf_rtc_event_t;
+
+typedef enum {
+    NRF_RTC_TASK_START,
+} nrf_rtc_task_t;
+
+static inline void nrf_rtc_prescaler_set(NRF_RTC_Type *p_reg, uint32_t val)
+{
+    p_reg->prescaler = val;
+}
+
+static inline void nrf_rtc_task_trigger(NRF_RTC_Type *p_reg, nrf_rtc_task_t task)
+{
+}
+
+static inline uint32_t nrf_rtc_counter_get(NRF_RTC_Type const *p_reg)
+{
+    return test_app_timer_cnt & APP_TIMER_MAX_CNT_VAL;
+}
+
+static inline void nrf_rtc_cc_set(NRF_RTC_Type *p_reg, uint32_t ch, uint32_t cc_val)
+{
+    p_reg->cc[ch] = cc_val & APP_TIMER_MAX_CNT_VAL;
+}
+
+static inline uint32_t nrf_rtc_cc_get(NRF_RTC_Type const *p_reg, uint32_t ch)
+{
+    return p_reg->cc[ch];
+}
+
+static inline void nrf_rtc_event_clear(NRF_RTC_Type *p_reg, nrf_rtc_event_t event)
+{
+    p_reg->events_compare[event] = 0;
+}
+
+static inline void nrf_rtc_int_enable(NRF_RTC_Type *p_reg, uint32_t mask)
+{
+    p_reg->inten |= mask;
+}
+
+static inline void nrf_rtc_int_disable(NRF_RTC_Type *p_reg, uint32_t mask)
+{
+    p_reg->inten &= ~mask;
+}
+
+static inline bool nrf_rtc_int_is_enabled(NRF_RTC_Type const *p_reg, uint32_t mask)
+{
+    return (p_reg->inten & mask) != 0;
+}
+
+#endif
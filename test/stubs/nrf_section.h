@@ -0,0 +1,22 @@
+#ifndef NRF_SECTION_H
+#define NRF_SECTION_H
+
+#include <stddef.h>
+
+/* the host linker brackets sections named like C identifiers with
+ * __start_ and __stop_ symbols, as the firmware linker script does */
+
+#define NRF_SECTION_DEF(section_name, data_type)                             \
+    extern data_type __start_##section_name[];                               \
+    extern data_type __stop_##section_name[]
+
+#define NRF_SECTION_ITEM_REGISTER(section_name, section_var)                 \
+    section_var __attribute__((section(#section_name), used))
+
+#define NRF_SECTION_ITEM_COUNT(section_name, data_type)                      \
+    ((size_t)(__stop_##section_name - __start_##section_name))
+
+#define NRF_SECTION_ITEM_GET(section_name, data_type, i)                     \
+    (&__start_##section_name[(i)])
+
+#endif
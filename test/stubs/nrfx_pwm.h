@@ -0,0 +1,17 @@
+#ifndef NRFX_PWM_H
+#define NRFX_PWM_H
+
+#include <stdint.h>
+
+typedef struct {
+    uint8_t drv_inst_idx;
+} nrfx_pwm_t;
+
+typedef enum {
+    NRFX_PWM_EVT_FINISHED,
+    NRFX_PWM_EVT_END_SEQ0,
+    NRFX_PWM_EVT_END_SEQ1,
+    NRFX_PWM_EVT_STOPPED,
+} nrfx_pwm_evt_type_t;
+
+#endif
@@ -0,0 +1,15 @@
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+/* the modules under test, enabled with their default settings */
+
+#define DITHER_ENABLED 1
+#define DITHER_BUFFER_LENGTH 256
+
+/* the tests report for themselves */
+#define IDLE_CONFIG_LOG_LEVEL 0
+#define IDLE_REPORT_PERIOD_MS 0
+#define WORK_CONFIG_LOG_LEVEL 0
+#define WORK_REPORT_PERIOD_MS 0
+
+#endif
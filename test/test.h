@@ -0,0 +1,18 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* stops the test with the failing expression */
+#define CHECK(expr)                                                          \
+    do {                                                                     \
+        if (!(expr))                                                         \
+        {                                                                    \
+            fprintf(stderr, "%s:%d: check failed: %s\n",                     \
+                    __FILE__, __LINE__, #expr);                              \
+            exit(1);                                                         \
+        }                                                                    \
+    } while (0)
+
+#endif
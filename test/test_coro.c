@@ -0,0 +1,144 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "coro.h"
+#include "test.h"
+
+enum { test_coros = 500 };
+
+/* a few KB for all of them */
+enum { test_coro_budget = 6 * 1024 };
+
+uint32_t test_app_timer_cnt;
+
+static coro_t coros[test_coros];
+
+/* per-coroutine context, locals do not survive a suspension */
+static uint32_t woken_at[test_coros];
+static uint32_t finished_at[test_coros];
+
+static bool go;
+
+static uint32_t test_delay(uint32_t i)
+{
+    return i % 16 + 1;
+}
+
+static coro_state_t test_thread(coro_t *c)
+{
+    uint32_t i = c - coros;
+
+    CORO_BEGIN(c);
+
+    CORO_AWAIT(c, go);
+    woken_at[i] = app_timer_cnt_get();
+
+    CORO_DELAY(c, test_delay(i));
+    finished_at[i] = app_timer_cnt_get();
+
+    CORO_YIELD(c);
+
+    CORO_END(c);
+}
+
+static void test_size(void)
+{
+    /* lc, padding and two timestamps */
+    CHECK(sizeof(coro_t) == 12);
+    CHECK(sizeof(coros) <= test_coro_budget);
+}
+
+static void test_concurrent(void)
+{
+    uint32_t done;
+    uint32_t i;
+    int round;
+
+    /* across the wrap of the 24-bit counter */
+    test_app_timer_cnt = 0x00fffff8;
+
+    for (i = 0; i < test_coros; i++)
+    {
+        CORO_INIT(&coros[i]);
+        CHECK(coro_deadline(&coros[i]) == CORO_NO_DEADLINE);
+    }
+
+    /* all of them are suspended on the same condition */
+    for (round = 0; round < 3; round++)
+    {
+        for (i = 0; i < test_coros; i++)
+        {
+            CHECK(test_thread(&coros[i]) == CORO_WAITING);
+            CHECK(coro_deadline(&coros[i]) == CORO_NO_DEADLINE);
+        }
+    }
+
+    go = true;
+
+    for (i = 0; i < test_coros; i++)
+    {
+        CHECK(test_thread(&coros[i]) == CORO_WAITING);
+        CHECK(coro_deadline(&coros[i]) == test_delay(i));
+    }
+
+    for (round = 0, done = 0; done < test_coros; round++)
+    {
+        CHECK(round < 64);
+
+        test_app_timer_cnt++;
+
+        for (i = 0; i < test_coros; i++)
+        {
+            if (CORO_IS_DONE(&coros[i]))
+            {
+                continue;
+            }
+
+            if (test_thread(&coros[i]) == CORO_DONE)
+            {
+                done++;
+            }
+        }
+    }
+
+    for (i = 0; i < test_coros; i++)
+    {
+        /* resumed on the first poll with the delay expired */
+        CHECK(app_timer_cnt_diff_compute(finished_at[i], woken_at[i]) == test_delay(i));
+        CHECK(coro_deadline(&coros[i]) == CORO_NO_DEADLINE);
+        CHECK(test_thread(&coros[i]) == CORO_DONE);
+    }
+}
+
+static void test_reinit_in_delay(void)
+{
+    coro_t *c = &coros[0];
+
+    test_app_timer_cnt = 0;
+    go = true;
+
+    CORO_INIT(c);
+    CHECK(test_thread(c) == CORO_WAITING);
+    CHECK(coro_deadline(c) == test_delay(0));
+
+    /* restarted while suspended in CORO_DELAY() */
+    CORO_INIT(c);
+    CHECK(coro_deadline(c) == CORO_NO_DEADLINE);
+
+    go = false;
+    CHECK(test_thread(c) == CORO_WAITING);
+    CHECK(coro_deadline(c) == CORO_NO_DEADLINE);
+}
+
+int main(void)
+{
+    test_size();
+    test_concurrent();
+    test_reinit_in_delay();
+
+    printf("test_coro: %u coroutines in %u bytes\n",
+           (unsigned int)test_coros, (unsigned int)sizeof(coros));
+
+    return 0;
+}
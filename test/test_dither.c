@@ -0,0 +1,97 @@
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "dither.h"
+#include "pwm_stream.h"
+#include "test.h"
+
+enum { test_top_value = 100 };
+
+/* 16 buffers, 25.6 ms at 160 kHz; the first-order error over a window is
+ * below one PWM count, 65536 / (top * window) = 0.16 LSB at 16 bits */
+enum { test_window = 16 * DITHER_BUFFER_LENGTH };
+
+enum { test_polarity = 0x8000 };
+
+static pwm_stream_fill_t test_fill;
+static uint16_t *p_test_buffers;
+
+/* the stream itself is not under test, only what dither fills it with */
+void pwm_stream_start(nrfx_pwm_t const *p_pwm,
+                      uint16_t *p_values,
+                      uint16_t length,
+                      uint16_t repeats,
+                      pwm_stream_fill_t fill)
+{
+    CHECK(length == DITHER_BUFFER_LENGTH);
+    CHECK(repeats == 0);
+
+    p_test_buffers = p_values;
+    test_fill = fill;
+}
+
+/* PWM counts over one window, filled one buffer at a time and alternating
+ * between the two buffers as the stream does */
+static uint32_t test_window_counts(void)
+{
+    uint32_t counts = 0;
+    uint16_t *p_values;
+    uint32_t buffer;
+    uint32_t i;
+
+    for (buffer = 0; buffer < test_window / DITHER_BUFFER_LENGTH; buffer++)
+    {
+        p_values = &p_test_buffers[(buffer % 2) * DITHER_BUFFER_LENGTH];
+
+        test_fill(p_values, DITHER_BUFFER_LENGTH);
+
+        for (i = 0; i < DITHER_BUFFER_LENGTH; i++)
+        {
+            CHECK(p_values[i] & test_polarity);
+            CHECK((p_values[i] & ~test_polarity) <= test_top_value);
+
+            counts += p_values[i] & ~test_polarity;
+        }
+    }
+
+    return counts;
+}
+
+int main(void)
+{
+    static nrfx_pwm_t const pwm = { 0 };
+    /* in 1/65536 of a PWM count */
+    int64_t expected;
+    int64_t error;
+    int64_t worst = 0;
+    uint32_t duty;
+
+    dither_start(&pwm, test_top_value);
+
+    CHECK(test_fill != NULL);
+
+    /* every 16-bit duty cycle in turn, without restarting in between, so
+     * the accumulator is carried over from one setting to the next */
+    for (duty = 0; duty <= UINT16_MAX; duty++)
+    {
+        dither_set((uint16_t)duty);
+
+        expected = (int64_t)duty * test_top_value * test_window;
+        error = (int64_t)test_window_counts() * 65536 - expected;
+
+        /* the average duty error over the window in 16-bit LSB is
+         * error / (top * window), within 1 LSB */
+        CHECK(llabs(error) <= (int64_t)test_top_value * test_window);
+
+        if (llabs(error) > worst)
+        {
+            worst = llabs(error);
+        }
+    }
+
+    printf("test_dither: worst average error %.3f LSB over %u periods\n",
+           (double)worst / ((double)test_top_value * test_window),
+           (unsigned int)test_window);
+
+    return 0;
+}
@@ -0,0 +1,165 @@
+#include <stdint.h>
+
+#include "dsp.h"
+#include "test.h"
+
+#define TEST_COUNT(a) (sizeof(a) / sizeof((a)[0]))
+
+enum { test_polarity = 0x8000 };
+
+typedef struct {
+    uint32_t phase;
+    int16_t sample;
+} test_nco_point_t;
+
+/* the quadrants land on table steps, the half steps interpolate between
+ * the first and last steps and zero */
+static test_nco_point_t const test_nco_points[] = {
+    { 0x00000000,      0 },
+    { 0x00800000,    402 },
+    { 0x01000000,    804 },
+    { 0x20000000,  23170 },
+    { 0x40000000,  32767 },
+    { 0x80000000,      0 },
+    { 0xc0000000, -32767 },
+    { 0xff000000,   -804 },
+    { 0xff800000,   -402 },
+};
+
+typedef struct {
+    int16_t a;
+    int16_t gain_a;
+    int16_t b;
+    int16_t gain_b;
+    int16_t out;
+} test_mix_vector_t;
+
+static test_mix_vector_t const test_mix_vectors[] = {
+    /* 0.5 * 0.5, rounded to nearest with halves rounded up */
+    {  16384,  16384,      0,      0,   8192 },
+    {  16384,  16384,  16384,  16384,  16384 },
+    {      1,  16384,      0,      0,      1 },
+    {     -1,  16384,      0,      0,      0 },
+    /* full scale on both inputs saturates instead of wrapping */
+    {  32767,  32767,  32767,  32767,  32767 },
+    { -32768,  32767, -32768,  32767, -32768 },
+    {  32767,  32767, -32768,  32767,     -1 },
+    /* -1.0 * -1.0 is the one product above full scale */
+    { -32768, -32768,      0,      0,  32767 },
+};
+
+typedef struct {
+    uint16_t top_value;
+    int16_t in;
+    uint16_t duty;
+} test_duty_vector_t;
+
+/* +1.0 is not a Q15 value, so the full scale input may stop a count short
+ * of the top value */
+static test_duty_vector_t const test_duty_vectors[] = {
+    {   100, -32768,     0 },
+    {   100,      0,    50 },
+    {   100,  32767,    99 },
+    {   101, -32768,     0 },
+    {   101,      0,    51 },
+    {   101,  32767,   101 },
+    { 32767, -32768,     0 },
+    { 32767,  32767, 32767 },
+};
+
+static void test_nco(void)
+{
+    dsp_nco_t nco;
+    int16_t out[5];
+    uint32_t i;
+
+    for (i = 0; i < TEST_COUNT(test_nco_points); i++)
+    {
+        nco.phase = test_nco_points[i].phase;
+        nco.phase_inc = 0;
+
+        dsp_nco_q15_ref(&nco, out, 1);
+
+        CHECK(out[0] == test_nco_points[i].sample);
+    }
+
+    /* a quarter period per sample, the phase wraps back to the start */
+    nco.phase = 0;
+    nco.phase_inc = 0x40000000;
+
+    dsp_nco_q15_ref(&nco, out, 5);
+
+    CHECK(out[0] == 0);
+    CHECK(out[1] == 32767);
+    CHECK(out[2] == 0);
+    CHECK(out[3] == -32767);
+    CHECK(out[4] == 0);
+    CHECK(nco.phase == 0x40000000);
+}
+
+static void test_mix(void)
+{
+    test_mix_vector_t const *p_v;
+    int16_t out;
+    uint32_t i;
+
+    for (i = 0; i < TEST_COUNT(test_mix_vectors); i++)
+    {
+        p_v = &test_mix_vectors[i];
+
+        dsp_mix_q15_ref(&out, &p_v->a, p_v->gain_a, &p_v->b, p_v->gain_b, 1);
+
+        CHECK(out == p_v->out);
+    }
+}
+
+static void test_scale_to_duty(void)
+{
+    static uint16_t const tops[] = { 1, 100, 101, 32767 };
+    test_duty_vector_t const *p_v;
+    uint16_t duty;
+    int32_t in;
+    int16_t x;
+    uint32_t i;
+
+    for (i = 0; i < TEST_COUNT(test_duty_vectors); i++)
+    {
+        p_v = &test_duty_vectors[i];
+
+        dsp_scale_to_duty_ref(&duty, &p_v->in, p_v->top_value, test_polarity, 1);
+
+        CHECK(duty == (p_v->duty | test_polarity));
+    }
+
+    /* every input stays within the counter, rising with the input */
+    for (i = 0; i < TEST_COUNT(tops); i++)
+    {
+        uint16_t last = 0;
+
+        for (in = INT16_MIN; in <= INT16_MAX; in++)
+        {
+            x = (int16_t)in;
+
+            dsp_scale_to_duty_ref(&duty, &x, tops[i], 0, 1);
+
+            CHECK(duty <= tops[i]);
+            CHECK(duty >= last);
+
+            last = duty;
+        }
+    }
+}
+
+int main(void)
+{
+    test_nco();
+    test_mix();
+    test_scale_to_duty();
+
+    printf("test_dsp: %u NCO points, %u mix and %u duty vectors\n",
+           (unsigned int)TEST_COUNT(test_nco_points),
+           (unsigned int)TEST_COUNT(test_mix_vectors),
+           (unsigned int)TEST_COUNT(test_duty_vectors));
+
+    return 0;
+}
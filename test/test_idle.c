@@ -0,0 +1,341 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "coro.h"
+#include "idle.h"
+#include "nrf_rtc.h"
+#include "test.h"
+#include "work.h"
+
+/* one minute of the default build with no USB host attached, across the
+ * wrap of the 24-bit counter */
+enum { test_duration_ms = 60000 };
+enum { test_start_cnt = APP_TIMER_MAX_CNT_VAL - 32768 };
+
+/* awake time is counted in whole RTC ticks of 30.5 us, so these round the
+ * work up and the result is a lower bound on the time asleep */
+enum { test_pass_ticks = 2 };   /* a main loop pass forwarding a log entry */
+
+/* lowest share of the time asleep accepted, in 1/1000 */
+enum { test_min_asleep = 990 };
+
+/* loop passes in a row without the clock moving before the core is taken
+ * to spin instead of sleeping */
+enum { test_max_spins = 8 };
+
+/* display_init_thread() fading in, as in main.c */
+enum { test_display_intensity = 5 };
+enum { test_fade_step_ms = 40 };
+
+uint32_t test_app_timer_cnt;
+
+NRF_RTC_Type test_rtc1;
+NRF_RTC_Type test_rtc2;
+
+void RTC2_IRQHandler(void);
+
+/* the app_timer users of the default build; the blinky timer alternates
+ * between its on and off periods */
+typedef struct {
+    uint32_t period[2];
+    uint32_t cost;              /* handler ticks, SPI completions included */
+    uint32_t work;              /* what the handler leaves to the main loop */
+    bool running;
+    uint32_t phase;
+    uint64_t expiry;
+} test_timer_t;
+
+enum {
+    TEST_TIMER_BLINKY,
+    TEST_TIMER_COUNTER,
+    TEST_TIMER_WORK_REPORT,
+    TEST_TIMER_IDLE_REPORT,
+    TEST_TIMER_STACK_REPORT,
+    TEST_TIMER_COUNT
+};
+
+static test_timer_t test_timers[TEST_TIMER_COUNT] = {
+    /* toggles the LED and logs to the info lane */
+    [TEST_TIMER_BLINKY] = {
+        .period = { APP_TIMER_TICKS(250), APP_TIMER_TICKS(1000) },
+        .cost = 1,
+        .work = WORK_LOG_LANES,
+    },
+    /* writes the eight digits over SPIM0 */
+    [TEST_TIMER_COUNTER] = {
+        .period = { APP_TIMER_TICKS(250), APP_TIMER_TICKS(250) },
+        .cost = 2,
+    },
+    [TEST_TIMER_WORK_REPORT] = {
+        .period = { APP_TIMER_TICKS(10000), APP_TIMER_TICKS(10000) },
+        .cost = 1,
+        .work = WORK_LOG,
+    },
+    [TEST_TIMER_IDLE_REPORT] = {
+        .period = { APP_TIMER_TICKS(10000), APP_TIMER_TICKS(10000) },
+        .cost = 1,
+        .work = WORK_LOG,
+    },
+    [TEST_TIMER_STACK_REPORT] = {
+        .period = { APP_TIMER_TICKS(10000), APP_TIMER_TICKS(10000) },
+        .cost = 1,
+        .work = WORK_LOG,
+    },
+};
+
+/* ticks since the start, not wrapping */
+static uint64_t test_time;
+static uint64_t test_asleep;
+static uint32_t test_wakeups;
+
+static bool test_event;
+
+static coro_t test_display_coro;
+static uint64_t test_fade_at[test_display_intensity + 1];
+
+static void test_advance(uint32_t ticks)
+{
+    test_time += ticks;
+    test_app_timer_cnt += ticks;
+}
+
+/* RTC1 CC[0] follows the earliest running timer, as app_timer keeps it */
+static void test_app_timer_update(void)
+{
+    test_timer_t const *p_next = NULL;
+    int i;
+
+    for (i = 0; i < TEST_TIMER_COUNT; i++)
+    {
+        if (test_timers[i].running
+            && (p_next == NULL || test_timers[i].expiry < p_next->expiry))
+        {
+            p_next = &test_timers[i];
+        }
+    }
+
+    if (p_next == NULL)
+    {
+        nrf_rtc_int_disable(NRF_RTC1, NRF_RTC_INT_COMPARE0_MASK);
+        return;
+    }
+
+    nrf_rtc_cc_set(NRF_RTC1, 0, test_start_cnt + p_next->expiry);
+    nrf_rtc_int_enable(NRF_RTC1, NRF_RTC_INT_COMPARE0_MASK);
+}
+
+static void test_timer_start(test_timer_t *p_timer)
+{
+    p_timer->running = true;
+    p_timer->phase = 0;
+    p_timer->expiry = test_time + p_timer->period[0];
+
+    test_app_timer_update();
+}
+
+/* the RTC1 interrupt, running every handler that has expired */
+static void test_app_timer_irq(void)
+{
+    bool expired = true;
+    int i;
+
+    while (expired)
+    {
+        expired = false;
+
+        for (i = 0; i < TEST_TIMER_COUNT; i++)
+        {
+            test_timer_t *p_timer = &test_timers[i];
+
+            if (!p_timer->running || p_timer->expiry > test_time)
+            {
+                continue;
+            }
+
+            test_advance(p_timer->cost);
+
+            if (p_timer->work != 0)
+            {
+                work_signal(p_timer->work);
+            }
+
+            p_timer->expiry += p_timer->period[p_timer->phase];
+            p_timer->phase ^= 1;
+            expired = true;
+        }
+    }
+
+    test_app_timer_update();
+}
+
+/* time spent awake, the RTC1 interrupt preempts whatever runs */
+static void test_busy(uint32_t ticks)
+{
+    test_advance(ticks);
+    test_app_timer_irq();
+}
+
+/* ticks until the compare of an RTC fires, UINT32_MAX if it cannot */
+static uint32_t test_rtc_ticks_left(NRF_RTC_Type const *p_rtc)
+{
+    uint32_t ticks;
+
+    if (!nrf_rtc_int_is_enabled(p_rtc, NRF_RTC_INT_COMPARE0_MASK))
+    {
+        return UINT32_MAX;
+    }
+
+    ticks = app_timer_cnt_diff_compute(nrf_rtc_cc_get(p_rtc, 0),
+                                       nrf_rtc_counter_get(p_rtc));
+
+    /* a compare equal to the counter only matches after a full turn */
+    return ticks == 0 ? APP_TIMER_MAX_CNT_VAL + 1 : ticks;
+}
+
+void __SEV(void)
+{
+    test_event = true;
+}
+
+/* sleeps until the first enabled compare, the only interrupts left when no
+ * USB host is attached */
+void __WFE(void)
+{
+    uint32_t rtc1_ticks;
+    uint32_t rtc2_ticks;
+    uint32_t ticks;
+
+    if (test_event)
+    {
+        test_event = false;
+        return;
+    }
+
+    rtc1_ticks = test_rtc_ticks_left(NRF_RTC1);
+    rtc2_ticks = test_rtc_ticks_left(NRF_RTC2);
+    ticks = rtc1_ticks < rtc2_ticks ? rtc1_ticks : rtc2_ticks;
+
+    /* nothing would ever wake the core */
+    CHECK(ticks != UINT32_MAX);
+
+    test_advance(ticks);
+    test_asleep += ticks;
+    test_wakeups++;
+
+    if (ticks == rtc2_ticks)
+    {
+        RTC2_IRQHandler();
+    }
+
+    if (ticks == rtc1_ticks)
+    {
+        test_app_timer_irq();
+    }
+}
+
+/* display_init_thread() past the SPI transfers, which complete by
+ * interrupt; what idle has to plan for are the fade delays */
+static coro_state_t test_display_thread(coro_t *c)
+{
+    static unsigned int i;
+
+    CORO_BEGIN(c);
+
+    for (i = 1; i <= test_display_intensity; i++)
+    {
+        CORO_DELAY(c, APP_TIMER_TICKS(test_fade_step_ms));
+        test_fade_at[i] = test_time;
+    }
+
+    test_timer_start(&test_timers[TEST_TIMER_COUNTER]);
+
+    CORO_END(c);
+}
+
+static uint32_t test_display_deadline(void)
+{
+    return coro_deadline(&test_display_coro);
+}
+
+IDLE_DEADLINE_REGISTER(test_display, test_display_deadline, WORK_DISPLAY);
+
+/* the main loop of main.c with the work of the default build */
+static void test_main_loop(uint64_t end)
+{
+    uint64_t last = test_time;
+    uint32_t spins = 0;
+
+    while (test_time < end)
+    {
+        uint32_t work = work_take();
+
+        if (work & WORK_DISPLAY)
+        {
+            test_display_thread(&test_display_coro);
+        }
+
+        /* USB is polled after every wakeup and finds nothing to do */
+        if (work & ~(WORK_USB | WORK_DISPLAY))
+        {
+            test_busy(test_pass_ticks);
+        }
+
+        if (idle_run())
+        {
+            work_signal(WORK_USB);
+        }
+
+        spins = test_time == last ? spins + 1 : 0;
+        last = test_time;
+
+        CHECK(spins < test_max_spins);
+    }
+}
+
+int main(void)
+{
+    uint64_t end = APP_TIMER_TICKS(test_duration_ms);
+    uint32_t fade_step = APP_TIMER_TICKS(test_fade_step_ms);
+    uint32_t asleep;
+    int i;
+
+    test_app_timer_cnt = test_start_cnt;
+
+    /* display_init() and the rest of main() */
+    test_timer_start(&test_timers[TEST_TIMER_BLINKY]);
+    test_timer_start(&test_timers[TEST_TIMER_WORK_REPORT]);
+    test_timer_start(&test_timers[TEST_TIMER_IDLE_REPORT]);
+    test_timer_start(&test_timers[TEST_TIMER_STACK_REPORT]);
+
+    CORO_INIT(&test_display_coro);
+    work_signal(WORK_DISPLAY);
+
+    work_init();
+    idle_init();
+
+    work_signal(WORK_LOG | WORK_USB);
+
+    test_main_loop(end);
+
+    /* every fade step resumed by the idle compare, at most one pass late */
+    for (i = 1; i <= test_display_intensity; i++)
+    {
+        uint64_t step = test_fade_at[i] - test_fade_at[i - 1];
+
+        CHECK(test_fade_at[i] != 0);
+        CHECK(step >= fade_step && step <= fade_step + 2 * test_pass_ticks);
+    }
+
+    CHECK(test_timers[TEST_TIMER_COUNTER].running);
+
+    asleep = (uint32_t)(test_asleep * 1000 / test_time);
+
+    printf("test_idle: asleep %u.%u%% of %u ms, %u wakeups\n",
+           asleep / 10, asleep % 10,
+           (unsigned int)(test_time * 1000 / APP_TIMER_CLOCK_FREQ),
+           test_wakeups);
+
+    CHECK(asleep >= test_min_asleep);
+
+    return 0;
+}
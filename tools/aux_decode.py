@@ -0,0 +1,286 @@
+#!/usr/bin/env python3
+"""Decode the binary stream of the auxiliary USB CDC port.
+
+Format strings and module names are not sent by the firmware; they are read
+from the ELF file the firmware was built from, so the ELF must match the
+running image.
+
+    tools/aux_decode.py _build/nrf52840_xxaa.out --port /dev/ttyACM1
+    tools/aux_decode.py _build/nrf52840_xxaa.out --file capture.bin
+
+Requires pyelftools, and pyserial for --port.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+FRAME_SYNC = 0xA5
+
+FRAME_LOG = 0x01
+FRAME_LOG_HEXDUMP = 0x02
+FRAME_LOG_PACKED = 0x03
+FRAME_METRICS = 0x04
+
+PACKED_NARGS_POS = 3
+PACKED_ABSOLUTE = 0x40
+
+LOG_CLOCK_HZ = 16000000
+
+SEVERITIES = {1: "error", 2: "warning", 3: "info", 4: "debug"}
+
+LOG_MODULE_CONST_SIZE = 8
+
+METRIC_SIZE = 12
+METRIC_COUNTER, METRIC_GAUGE, METRIC_PEAK = range(3)
+
+C_SPEC = re.compile(r"%([-+ 0#]*)(\d+)?(?:\.(\d+))?(?:hh|h|ll|l|z|j|t)?([diuxXcsp%])")
+
+
+class Image:
+    """Read-only view of the allocated sections of an ELF file."""
+
+    def __init__(self, path):
+        self.regions = []
+        self.sections = {}
+
+        with open(path, "rb") as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if not section["sh_flags"] & 0x2 or section["sh_type"] != "SHT_PROGBITS":
+                    continue
+                data = section.data()
+                self.regions.append((section["sh_addr"], data))
+                self.sections[section.name] = (section["sh_addr"], data)
+
+    def read(self, address, length):
+        for base, data in self.regions:
+            if base <= address and address + length <= base + len(data):
+                offset = address - base
+                return data[offset:offset + length]
+        return None
+
+    def string(self, address):
+        for base, data in self.regions:
+            if base <= address < base + len(data):
+                offset = address - base
+                end = data.find(b"\0", offset)
+                return data[offset:end].decode("ascii", "replace")
+        return None
+
+    def word(self, address):
+        data = self.read(address, 4)
+        return struct.unpack("<I", data)[0] if data else None
+
+    def log_module_names(self):
+        names = []
+        base, data = self.sections.get(".log_const_data", (0, b""))
+        for offset in range(0, len(data), LOG_MODULE_CONST_SIZE):
+            pointer = struct.unpack_from("<I", data, offset)[0]
+            names.append(self.string(pointer) or "?")
+        return names
+
+    def metrics(self):
+        """(name, type) of every metric, in the order of the snapshot values."""
+        metrics = []
+        base, data = self.sections.get(".metrics", (0, b""))
+        for offset in range(0, len(data), METRIC_SIZE):
+            name, _, metric_type = struct.unpack_from("<IIB", data, offset)
+            metrics.append((self.string(name) or "?", metric_type))
+        return metrics
+
+
+def c_format(image, fmt, args):
+    """Apply a C printf format to raw 32-bit argument words."""
+    args = list(args)
+
+    def convert(match):
+        flags, width, precision, conv = match.groups()
+        if conv == "%":
+            return "%"
+        if not args:
+            return match.group(0)
+        value = args.pop(0)
+        spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+        if conv in "di":
+            return (spec + "d") % struct.unpack("<i", struct.pack("<I", value))[0]
+        if conv == "u":
+            return (spec + "d") % value
+        if conv in "xX":
+            return (spec + conv) % value
+        if conv == "p":
+            return "0x%08x" % value
+        if conv == "c":
+            return (spec + "c") % chr(value & 0xFF)
+        text = image.string(value)
+        if text is None:
+            text = "<ram 0x%08x>" % value
+        return (spec + "s") % text
+
+    return C_SPEC.sub(convert, fmt)
+
+
+def leb128(payload, offset):
+    """Decode an unsigned LEB128 varint, return (value, next offset)."""
+    value = 0
+    shift = 0
+    while True:
+        byte = payload[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if byte < 0x80:
+            return value, offset
+
+
+class Decoder:
+    def __init__(self, image, timestamp_shift=4):
+        self.image = image
+        self.modules = image.log_module_names()
+        self.handlers = {
+            FRAME_LOG: self.log,
+            FRAME_LOG_HEXDUMP: self.log_hexdump,
+            FRAME_LOG_PACKED: self.log_packed,
+            FRAME_METRICS: self.metrics,
+        }
+        self.metric_info = image.metrics()
+        self.metric_values = {}
+        self.timestamp_unit = (1 << timestamp_shift) / LOG_CLOCK_HZ
+        self.timestamp_mask = 0xFFFFFFFF >> timestamp_shift
+        self.timestamp = None   # absolute time of the last packed record, unwrapped
+
+    def module(self, module_id):
+        if module_id < len(self.modules):
+            return self.modules[module_id]
+        return "module%d" % module_id
+
+    def text(self, severity, module_id, fmt_address, args):
+        fmt = self.image.string(fmt_address)
+        if fmt is None:
+            text = "<unknown format 0x%08x> %s" % (fmt_address, " ".join("0x%x" % a for a in args))
+        else:
+            text = c_format(self.image, fmt, args)
+        return "<%s> %s: %s" % (SEVERITIES.get(severity, "?"), self.module(module_id), text)
+
+    def log(self, payload):
+        severity, nargs, module_id, fmt_address = struct.unpack_from("<BBHI", payload)
+        args = struct.unpack_from("<%dI" % nargs, payload, 8)
+        return self.text(severity, module_id, fmt_address, args)
+
+    def log_packed(self, payload):
+        flags = payload[0]
+        severity = flags & 0x7
+        nargs = (flags >> PACKED_NARGS_POS) & 0x7
+        stamp, offset = leb128(payload, 1)
+        module_id, offset = leb128(payload, offset)
+        fmt_address, offset = leb128(payload, offset)
+        args = []
+        for _ in range(nargs):
+            arg, offset = leb128(payload, offset)
+            args.append(arg)
+
+        if flags & PACKED_ABSOLUTE:
+            if self.timestamp is None:
+                self.timestamp = stamp
+            else:
+                # keep counting across wraps of the device clock
+                self.timestamp += (stamp - self.timestamp) & self.timestamp_mask
+        elif self.timestamp is not None:
+            self.timestamp += stamp
+
+        if self.timestamp is None:
+            when = "[ +%.6f]" % (stamp * self.timestamp_unit)
+        else:
+            when = "[%11.6f]" % (self.timestamp * self.timestamp_unit)
+        return when + " " + self.text(severity, module_id, fmt_address, args)
+
+    def log_hexdump(self, payload):
+        severity, _, module_id = struct.unpack_from("<BBH", payload)
+        data = payload[4:]
+        return "<%s> %s: %s" % (SEVERITIES.get(severity, "?"), self.module(module_id), data.hex(" "))
+
+    def metrics(self, payload):
+        sequence, period_ms, first = struct.unpack_from("<IHH", payload)
+        values = struct.unpack_from("<%dI" % ((len(payload) - 8) // 4), payload, 8)
+        fields = []
+        for index, value in enumerate(values, first):
+            name, metric_type = (self.metric_info[index] if index < len(self.metric_info)
+                                 else ("metric%d" % index, METRIC_GAUGE))
+            field = "%s=%u" % (name, value)
+            previous = self.metric_values.get(index)
+            if metric_type == METRIC_COUNTER and previous is not None and period_ms:
+                field += " (%.1f/s)" % (((value - previous) & 0xFFFFFFFF) * 1000.0 / period_ms)
+            self.metric_values[index] = value
+            fields.append(field)
+        return "metrics #%u: %s" % (sequence, ", ".join(fields))
+
+    def frame(self, frame_type, payload):
+        handler = self.handlers.get(frame_type)
+        if handler is None:
+            return "<frame 0x%02x, %d bytes>" % (frame_type, len(payload))
+        return handler(payload)
+
+    def stream(self, read):
+        """Yield decoded frames from a read(n) -> bytes callable."""
+        for frame_type, payload in frames(read):
+            try:
+                yield self.frame(frame_type, payload)
+            except (struct.error, IndexError):
+                yield "<malformed frame 0x%02x>" % frame_type
+
+
+def frames(read):
+    """Yield (type, payload) of every frame from a read(n) -> bytes callable."""
+    while True:
+        byte = read(1)
+        if not byte:
+            return
+        if byte[0] != FRAME_SYNC:
+            continue
+        header = read(3)
+        if len(header) < 3:
+            return
+        frame_type, length = struct.unpack("<BH", header)
+        payload = read(length)
+        if len(payload) < length:
+            return
+        yield frame_type, payload
+
+
+def open_input(args):
+    if args.file:
+        f = open(args.file, "rb")
+        return f.read
+
+    import serial
+
+    port = serial.Serial(args.port, timeout=None)
+    return port.read
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="firmware ELF file")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="auxiliary CDC ACM serial port")
+    source.add_argument("--file", help="raw capture of the auxiliary port")
+    parser.add_argument("--timestamp-shift", type=int, default=4,
+                        help="LOG_BACKEND_BIN_TIMESTAMP_SHIFT of the firmware")
+    args = parser.parse_args()
+
+    decoder = Decoder(Image(args.elf), args.timestamp_shift)
+
+    try:
+        for line in decoder.stream(open_input(args)):
+            print(line, flush=True)
+    except KeyboardInterrupt:
+        pass
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""Play a WAV file through PWM0 from the auxiliary USB port.
+
+The firmware must be built with USB_AUDIO_ENABLED. The file must hold
+16-bit PCM at USB_AUDIO_INPUT_RATE_HZ; several channels are mixed down to
+mono:
+
+    tools/aux_play.py music.wav --port /dev/ttyACM1
+
+The port applies USB flow control, so the file is written as fast as the
+firmware takes it. Requires pyserial.
+"""
+
+import argparse
+import array
+import sys
+import wave
+
+import serial
+
+CHUNK_FRAMES = 1024
+
+
+def mono(data, channels):
+    """Signed 16-bit little-endian mono samples of interleaved frames."""
+    samples = array.array("h")
+    samples.frombytes(data)
+    if sys.byteorder != "little":
+        samples.byteswap()
+
+    if channels > 1:
+        samples = array.array("h", (sum(samples[i:i + channels]) // channels
+                                    for i in range(0, len(samples), channels)))
+
+    if sys.byteorder != "little":
+        samples.byteswap()
+    return samples.tobytes()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("wav", help="16-bit PCM WAV file")
+    parser.add_argument("--port", required=True, help="auxiliary CDC ACM serial port")
+    parser.add_argument("--rate", type=int, default=16000,
+                        help="USB_AUDIO_INPUT_RATE_HZ of the firmware")
+    args = parser.parse_args()
+
+    with wave.open(args.wav, "rb") as wav:
+        if wav.getsampwidth() != 2:
+            sys.exit("%s: not 16-bit PCM" % args.wav)
+        if wav.getframerate() != args.rate:
+            sys.exit("%s: %u Hz, the firmware expects %u Hz"
+                     % (args.wav, wav.getframerate(), args.rate))
+
+        port = serial.Serial(args.port, write_timeout=None)
+
+        try:
+            while True:
+                data = wav.readframes(CHUNK_FRAMES)
+                if not data:
+                    break
+                port.write(mono(data, wav.getnchannels()))
+        except KeyboardInterrupt:
+            pass
+
+        port.close()
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
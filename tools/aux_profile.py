@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""Build a flat profile from the PC samples on the auxiliary USB port.
+
+The firmware must be built with PROFILER_ENABLED. Sample buckets are mapped
+to functions through the symbol table of the ELF the firmware was built
+from:
+
+    tools/aux_profile.py _build/nrf52840_xxaa.out --port /dev/ttyACM1
+    tools/aux_profile.py _build/nrf52840_xxaa.out --file capture.bin
+
+The profile accumulated so far is printed every --interval reports and at
+the end of the input. Requires pyelftools, and pyserial for --port.
+"""
+
+import argparse
+import bisect
+import collections
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+from aux_decode import frames, open_input
+
+FRAME_PROFILE = 0x05
+
+PROFILE_HEADER = "<IIIBBH"
+PROFILE_ENTRY = "<II"
+
+
+class Symbols:
+    """Function lookup by address."""
+
+    def __init__(self, path):
+        functions = []
+        with open(path, "rb") as f:
+            symtab = ELFFile(f).get_section_by_name(".symtab")
+            for symbol in symtab.iter_symbols() if symtab else ():
+                if symbol["st_info"]["type"] == "STT_FUNC" and symbol["st_size"]:
+                    start = symbol["st_value"] & ~1     # drop the Thumb bit
+                    functions.append((start, start + symbol["st_size"], symbol.name))
+        functions.sort()
+        self.starts = [start for start, _, _ in functions]
+        self.functions = functions
+
+    def lookup(self, address):
+        index = bisect.bisect_right(self.starts, address) - 1
+        if index >= 0:
+            start, end, name = self.functions[index]
+            if address < end:
+                return name
+        return "0x%08x" % address
+
+
+class Profile:
+    def __init__(self, symbols):
+        self.symbols = symbols
+        self.counts = collections.Counter()
+        self.samples = 0
+        self.lost = 0
+        self.reports = 0
+        self.sequence = None
+
+    def add(self, payload):
+        sequence, samples, lost, shift, _, count = struct.unpack_from(PROFILE_HEADER, payload)
+        offset = struct.calcsize(PROFILE_HEADER)
+
+        # a report split over several frames repeats its totals in each
+        if sequence != self.sequence:
+            self.sequence = sequence
+            self.samples += samples
+            self.lost += lost
+            self.reports += 1
+
+        for _ in range(count):
+            bucket, hits = struct.unpack_from(PROFILE_ENTRY, payload, offset)
+            offset += struct.calcsize(PROFILE_ENTRY)
+            self.counts[self.symbols.lookup(bucket << shift)] += hits
+
+    def print(self, top):
+        total = sum(self.counts.values())
+        print("%u reports, %u samples, %u lost" % (self.reports, self.samples, self.lost))
+        print("%7s %9s  %s" % ("%", "samples", "function"))
+        for name, hits in self.counts.most_common(top):
+            print("%6.2f%% %9u  %s" % (100.0 * hits / total, hits, name))
+        print(flush=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="firmware ELF file")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--port", help="auxiliary CDC ACM serial port")
+    source.add_argument("--file", help="raw capture of the auxiliary port")
+    parser.add_argument("--interval", type=int, default=10,
+                        help="reports between printed profiles")
+    parser.add_argument("--top", type=int, default=25, help="functions to print")
+    args = parser.parse_args()
+
+    profile = Profile(Symbols(args.elf))
+    printed = 0
+
+    try:
+        for frame_type, payload in frames(open_input(args)):
+            if frame_type != FRAME_PROFILE:
+                continue
+            try:
+                profile.add(payload)
+            except struct.error:
+                continue
+            if profile.reports - printed >= args.interval:
+                profile.print(args.top)
+                printed = profile.reports
+    except KeyboardInterrupt:
+        pass
+
+    if profile.reports:
+        profile.print(args.top)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
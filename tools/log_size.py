@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Compare the code and data size of two firmware builds.
+
+Build once, keep the ELF, change the log ceilings in config/app_config.h
+(or NRF_LOG_FILTERS_ENABLED) and build again:
+
+    cp _build/nrf52840_xxaa.out /tmp/before.out
+    make
+    tools/log_size.py _build/nrf52840_xxaa.out --baseline /tmp/before.out
+
+Prints the allocated sections and the log_levels benchmark sites of both
+builds with the difference. Requires pyelftools.
+"""
+
+import argparse
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+SHF_ALLOC = 0x2
+
+BENCH_PREFIX = "log_levels_bench_"
+
+
+def sizes(path):
+    """Sizes of the allocated sections and of the benchmark functions."""
+    sections = {}
+    symbols = {}
+
+    with open(path, "rb") as f:
+        elf = ELFFile(f)
+
+        for section in elf.iter_sections():
+            if section["sh_flags"] & SHF_ALLOC and section["sh_size"]:
+                sections[section.name] = section["sh_size"]
+
+        symtab = elf.get_section_by_name(".symtab")
+        for symbol in symtab.iter_symbols() if symtab else ():
+            if symbol.name.startswith(BENCH_PREFIX) and symbol["st_info"]["type"] == "STT_FUNC":
+                symbols[symbol.name] = symbol["st_size"]
+
+    return sections, symbols
+
+
+def table(title, current, baseline):
+    print(title)
+    total = 0
+    total_base = 0
+    for name in sorted(set(current) | set(baseline or {})):
+        size = current.get(name, 0)
+        total += size
+        if baseline is None:
+            print(f"  {name:32} {size:8}")
+            continue
+        base = baseline.get(name, 0)
+        total_base += base
+        print(f"  {name:32} {base:8} -> {size:8} {size - base:+8}")
+    if baseline is None:
+        print(f"  {'total':32} {total:8}")
+    else:
+        print(f"  {'total':32} {total_base:8} -> {total:8} {total - total_base:+8}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf", help="firmware ELF file")
+    parser.add_argument("--baseline", help="ELF file of the build to compare against")
+    args = parser.parse_args()
+
+    sections, symbols = sizes(args.elf)
+    base_sections, base_symbols = sizes(args.baseline) if args.baseline else (None, None)
+
+    table("sections", sections, base_sections)
+    if symbols or base_symbols:
+        table("log sites", symbols, base_symbols)
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
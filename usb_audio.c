@@ -0,0 +1,180 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "usb_audio.h"
+
+#if USB_AUDIO_ENABLED
+
+#include "app_util.h"
+#include "dsp.h"
+#include "metrics.h"
+#include "pwm_stream.h"
+#include "usb_aux.h"
+#include "work.h"
+
+#define NRF_LOG_MODULE_NAME usb_audio
+#define NRF_LOG_LEVEL USB_AUDIO_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+STATIC_ASSERT((USB_AUDIO_BUFFER_SIZE & (USB_AUDIO_BUFFER_SIZE - 1)) == 0);
+
+/* duty values with bit 15 set, as in the fixed duty table */
+enum { usb_audio_polarity = 0x8000 };
+
+/* fill level, in bytes, that playback starts at and the rate control
+ * steers towards */
+enum { usb_audio_target = USB_AUDIO_BUFFER_SIZE / 2 };
+
+/* reception pauses below one full-speed bulk packet of room and resumes
+ * at a quarter of the ring */
+enum { usb_audio_rx_min = 64 };
+enum { usb_audio_rx_resume = USB_AUDIO_BUFFER_SIZE / 4 };
+
+/* full ring error trims the ratio by 1/200 */
+enum { usb_audio_trim_div = 200 * usb_audio_target };
+
+static int16_t usb_audio_ring[USB_AUDIO_BUFFER_SIZE / sizeof(int16_t)];
+
+/* free-running byte indices, head written from the main loop and tail from
+ * the PWM interrupt; the tail only ever moves by whole samples */
+static volatile uint32_t usb_audio_head;
+static volatile uint32_t usb_audio_tail;
+static volatile bool usb_audio_rx_paused;
+
+static uint16_t usb_audio_values[2 * USB_AUDIO_PWM_BUFFER_LENGTH];
+
+static uint16_t usb_audio_top;
+static uint32_t usb_audio_step;     /* input samples per output sample, Q16 */
+static uint32_t usb_audio_pos;      /* between usb_audio_s0 and usb_audio_s1, Q16 */
+static int32_t usb_audio_s0;
+static int32_t usb_audio_s1;
+static bool usb_audio_playing;
+
+METRIC_DEF(usb_audio_rx_bytes, METRIC_COUNTER);
+METRIC_DEF(usb_audio_underruns, METRIC_COUNTER);
+METRIC_DEF(usb_audio_overruns, METRIC_COUNTER);
+METRIC_DEF(usb_audio_fill, METRIC_GAUGE);
+
+static uint8_t *usb_audio_rx_get(uint32_t *p_length)
+{
+    uint32_t head = usb_audio_head;
+    uint32_t room = USB_AUDIO_BUFFER_SIZE - (head - usb_audio_tail);
+    uint32_t offset = head & (USB_AUDIO_BUFFER_SIZE - 1);
+
+    if (room < usb_audio_rx_min)
+    {
+        if (!usb_audio_rx_paused)
+        {
+            usb_audio_rx_paused = true;
+            METRIC_INC(usb_audio_overruns);
+        }
+
+        *p_length = 0;
+        return NULL;
+    }
+
+    /* up to the end of the ring, the next read continues at its start */
+    *p_length = MIN(room, USB_AUDIO_BUFFER_SIZE - offset);
+
+    return (uint8_t *)usb_audio_ring + offset;
+}
+
+static void usb_audio_rx_put(uint32_t length)
+{
+    usb_audio_head += length;
+    METRIC_ADD(usb_audio_rx_bytes, length);
+}
+
+static usb_aux_rx_sink_t const usb_audio_sink = {
+    .get = usb_audio_rx_get,
+    .put = usb_audio_rx_put,
+};
+
+static void usb_audio_fill(uint16_t *p_values, uint16_t length)
+{
+    int16_t *p_samples = (int16_t *)p_values;
+    uint32_t head = usb_audio_head;
+    uint32_t tail = usb_audio_tail;
+    int32_t error;
+    uint32_t step;
+    uint32_t i;
+
+    if (!usb_audio_playing && head - tail >= usb_audio_target)
+    {
+        usb_audio_playing = true;
+        NRF_LOG_INFO("playing");
+    }
+
+    error = (int32_t)(head - tail) - usb_audio_target;
+    step = usb_audio_step + (int32_t)(((int64_t)usb_audio_step * error) / usb_audio_trim_div);
+
+    for (i = 0; i < length; i++)
+    {
+        if (usb_audio_playing)
+        {
+            usb_audio_pos += step;
+
+            while (usb_audio_pos >= 0x10000)
+            {
+                usb_audio_pos -= 0x10000;
+
+                if (head - tail < sizeof(int16_t))
+                {
+                    usb_audio_playing = false;
+                    METRIC_INC(usb_audio_underruns);
+                    NRF_LOG_WARNING("underrun");
+                    break;
+                }
+
+                usb_audio_s0 = usb_audio_s1;
+                usb_audio_s1 = usb_audio_ring[(tail & (USB_AUDIO_BUFFER_SIZE - 1)) / sizeof(int16_t)];
+                tail += sizeof(int16_t);
+            }
+        }
+
+        if (!usb_audio_playing)
+        {
+            /* hold the last sample rather than click back to mid-scale */
+            usb_audio_s0 = usb_audio_s1;
+            usb_audio_pos = 0;
+        }
+
+        p_samples[i] = usb_audio_s0
+                       + (((usb_audio_s1 - usb_audio_s0) * (int32_t)(usb_audio_pos >> 1)) >> 15);
+    }
+
+    usb_audio_tail = tail;
+
+    METRIC_SET(usb_audio_fill, head - tail);
+
+    if (usb_audio_rx_paused
+        && USB_AUDIO_BUFFER_SIZE - (usb_audio_head - tail) >= usb_audio_rx_resume)
+    {
+        usb_audio_rx_paused = false;
+        work_signal(WORK_USB_AUX);
+    }
+
+    dsp_scale_to_duty(p_values, p_samples, usb_audio_top, usb_audio_polarity, length);
+}
+
+void usb_audio_start(nrfx_pwm_t const *p_pwm, uint16_t top_value, uint32_t pwm_frequency_hz)
+{
+    uint32_t periods = MAX(pwm_frequency_hz / USB_AUDIO_OUTPUT_RATE_HZ, 1);
+    uint32_t rate = pwm_frequency_hz / periods;
+
+    usb_audio_top = top_value;
+    usb_audio_step = ((uint64_t)USB_AUDIO_INPUT_RATE_HZ << 16) / rate;
+
+    NRF_LOG_INFO("%u Hz in, %u Hz out", USB_AUDIO_INPUT_RATE_HZ, rate);
+
+    usb_aux_rx_sink_set(&usb_audio_sink);
+
+    pwm_stream_start(p_pwm,
+                     usb_audio_values,
+                     USB_AUDIO_PWM_BUFFER_LENGTH,
+                     periods - 1,
+                     usb_audio_fill);
+}
+
+#endif
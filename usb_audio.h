@@ -0,0 +1,35 @@
+#ifndef USB_AUDIO_H
+#define USB_AUDIO_H
+
+#include <stdint.h>
+
+#include "nrfx_pwm.h"
+#include "sdk_config.h"
+
+/* PCM audio from the host played through PWM.
+ *
+ * The host writes signed 16-bit little-endian mono samples at
+ * USB_AUDIO_INPUT_RATE_HZ to the auxiliary USB port (tools/aux_play.py).
+ * They are received straight into a jitter ring of USB_AUDIO_BUFFER_SIZE
+ * bytes. Playback starts once the ring is half full, so the USB backlog the
+ * host can build up is absorbed by the other half.
+ *
+ * Each pwm_stream refill converts samples to the PWM sample rate by linear
+ * interpolation. The conversion ratio is trimmed by up to 0.5% in
+ * proportion to how far the ring is from half full, which follows the
+ * drift between the host clock and ours. A ring that runs dry holds the
+ * last sample and counts an underrun, then playback waits for half a ring
+ * again. A full ring pauses reception and counts an overrun; the host is
+ * held off by USB flow control, so no data is lost.
+ *
+ * usb_audio_underruns, usb_audio_overruns, usb_audio_rx_bytes and the
+ * usb_audio_fill gauge are published as metrics. */
+
+#if USB_AUDIO_ENABLED
+
+/* p_pwm must be set up as pwm_stream_start() requires */
+void usb_audio_start(nrfx_pwm_t const *p_pwm, uint16_t top_value, uint32_t pwm_frequency_hz);
+
+#endif
+
+#endif
@@ -0,0 +1,310 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "usb_aux.h"
+
+#if USB_AUX_ENABLED
+
+#include "metrics.h"
+#include "work.h"
+
+#define NRF_LOG_MODULE_NAME usb_aux
+#define NRF_LOG_LEVEL USB_AUX_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+#include "app_usbd.h"
+#include "app_usbd_cdc_acm.h"
+#include "app_util_platform.h"
+#include "nrf_drv_usbd.h"
+
+STATIC_ASSERT((USB_AUX_TX_BUFFER_SIZE & (USB_AUX_TX_BUFFER_SIZE - 1)) == 0);
+
+enum { usb_aux_frame_header_size = 4 };
+
+METRIC_DEF(usb_aux_tx_bytes, METRIC_COUNTER);
+METRIC_DEF(usb_aux_dropped_frames, METRIC_COUNTER);
+
+static void usb_aux_cdc_acm_ev_handler(app_usbd_class_inst_t const *p_inst,
+                                       app_usbd_cdc_acm_user_event_t event);
+
+APP_USBD_CDC_ACM_GLOBAL_DEF(usb_aux_cdc_acm,
+                            usb_aux_cdc_acm_ev_handler,
+                            USB_AUX_CDC_ACM_COMM_INTERFACE,
+                            USB_AUX_CDC_ACM_DATA_INTERFACE,
+                            NRF_DRV_USBD_EPIN(USB_AUX_CDC_ACM_COMM_EPIN),
+                            NRF_DRV_USBD_EPIN(USB_AUX_CDC_ACM_DATA_EPIN),
+                            NRF_DRV_USBD_EPOUT(USB_AUX_CDC_ACM_DATA_EPOUT),
+                            APP_USBD_CDC_COMM_PROTOCOL_NONE);
+
+static uint8_t usb_aux_tx_buffer[USB_AUX_TX_BUFFER_SIZE];
+
+/* free-running indices, masked on access */
+static volatile uint32_t usb_aux_tx_head;
+static volatile uint32_t usb_aux_tx_tail;
+
+static uint32_t usb_aux_tx_len;         /* bytes handed to the CDC class */
+static bool usb_aux_tx_busy = false;
+static bool usb_aux_port_open = false;
+
+static usb_aux_rx_sink_t const *p_usb_aux_rx_sink;
+static bool usb_aux_rx_busy = false;
+
+static usb_aux_stats_t usb_aux_stats;
+
+static void usb_aux_tx_start(void)
+{
+    uint32_t tail;
+    uint32_t length;
+    uint32_t offset;
+
+    if (usb_aux_tx_busy || !usb_aux_port_open)
+    {
+        return;
+    }
+
+    tail = usb_aux_tx_tail;
+    length = usb_aux_tx_head - tail;
+
+    if (length == 0)
+    {
+        return;
+    }
+
+    /* send straight from the ring, up to its end */
+    offset = tail & (USB_AUX_TX_BUFFER_SIZE - 1);
+
+    if (length > USB_AUX_TX_BUFFER_SIZE - offset)
+    {
+        length = USB_AUX_TX_BUFFER_SIZE - offset;
+    }
+
+    if (app_usbd_cdc_acm_write(&usb_aux_cdc_acm,
+                               &usb_aux_tx_buffer[offset],
+                               length) == NRF_SUCCESS)
+    {
+        usb_aux_tx_len = length;
+        usb_aux_tx_busy = true;
+    }
+}
+
+static void usb_aux_rx_start(void)
+{
+    usb_aux_rx_sink_t const *p_sink = p_usb_aux_rx_sink;
+    uint8_t *p_buf;
+    uint32_t length;
+    ret_code_t ret;
+
+    if (p_sink == NULL || usb_aux_rx_busy || !usb_aux_port_open)
+    {
+        return;
+    }
+
+    while (true)
+    {
+        p_buf = p_sink->get(&length);
+
+        if (length == 0)
+        {
+            return;
+        }
+
+        /* the class reads into the sink directly, or hands over what it
+         * has buffered already and returns NRF_SUCCESS */
+        ret = app_usbd_cdc_acm_read_any(&usb_aux_cdc_acm, p_buf, length);
+
+        if (ret != NRF_SUCCESS)
+        {
+            usb_aux_rx_busy = (ret == NRF_ERROR_IO_PENDING || ret == NRF_ERROR_BUSY);
+            return;
+        }
+
+        p_sink->put(app_usbd_cdc_acm_rx_size(&usb_aux_cdc_acm));
+    }
+}
+
+static void usb_aux_cdc_acm_ev_handler(app_usbd_class_inst_t const *p_inst,
+                                       app_usbd_cdc_acm_user_event_t event)
+{
+    switch (event)
+    {
+        case APP_USBD_CDC_ACM_USER_EVT_PORT_OPEN:
+            usb_aux_port_open = true;
+            usb_aux_tx_start();
+            usb_aux_rx_start();
+            break;
+
+        case APP_USBD_CDC_ACM_USER_EVT_PORT_CLOSE:
+            usb_aux_port_open = false;
+            usb_aux_tx_busy = false;
+            usb_aux_rx_busy = false;
+            break;
+
+        case APP_USBD_CDC_ACM_USER_EVT_RX_DONE:
+            usb_aux_rx_busy = false;
+            p_usb_aux_rx_sink->put(app_usbd_cdc_acm_rx_size(&usb_aux_cdc_acm));
+            usb_aux_rx_start();
+            break;
+
+        case APP_USBD_CDC_ACM_USER_EVT_TX_DONE:
+            usb_aux_tx_tail += usb_aux_tx_len;
+            usb_aux_stats.tx_bytes += usb_aux_tx_len;
+            METRIC_ADD(usb_aux_tx_bytes, usb_aux_tx_len);
+            usb_aux_tx_busy = false;
+            usb_aux_tx_start();
+            break;
+
+        default:
+            break;
+    }
+}
+
+#if LOG_BACKEND_BIN_ENABLED
+/* the text log backend is left out, so the stack is brought up here, the
+ * same way that backend does it */
+static void usb_aux_usbd_evt_handler(app_usbd_event_type_t event)
+{
+    switch (event)
+    {
+        case APP_USBD_EVT_POWER_DETECTED:
+            if (!nrf_drv_usbd_is_enabled())
+            {
+                app_usbd_enable();
+            }
+            break;
+
+        case APP_USBD_EVT_POWER_REMOVED:
+            app_usbd_stop();
+            break;
+
+        case APP_USBD_EVT_POWER_READY:
+            app_usbd_start();
+            break;
+
+        default:
+            break;
+    }
+}
+#endif
+
+void usb_aux_init(void)
+{
+    ret_code_t ret;
+
+#if LOG_BACKEND_BIN_ENABLED
+    static const app_usbd_config_t usbd_config = {
+        .ev_state_proc = usb_aux_usbd_evt_handler
+    };
+
+    ret = app_usbd_init(&usbd_config);
+
+    if (ret != NRF_SUCCESS)
+    {
+        NRF_LOG_ERROR("cannot init USB stack: %d", ret);
+        return;
+    }
+#endif
+
+    /* power events enable the stack later from the main loop, so the class
+     * can still be appended here */
+    ret = app_usbd_class_append(app_usbd_cdc_acm_class_inst_get(&usb_aux_cdc_acm));
+
+    if (ret != NRF_SUCCESS)
+    {
+        NRF_LOG_ERROR("cannot append CDC ACM class: %d", ret);
+        return;
+    }
+
+#if LOG_BACKEND_BIN_ENABLED
+    ret = app_usbd_power_events_enable();
+
+    if (ret != NRF_SUCCESS)
+    {
+        NRF_LOG_ERROR("cannot enable USB power events: %d", ret);
+    }
+#endif
+}
+
+static void usb_aux_copy_in(uint32_t head, void const *p_data, uint32_t length)
+{
+    uint32_t offset = head & (USB_AUX_TX_BUFFER_SIZE - 1);
+    uint32_t first = USB_AUX_TX_BUFFER_SIZE - offset;
+
+    if (first > length)
+    {
+        first = length;
+    }
+
+    memcpy(&usb_aux_tx_buffer[offset], p_data, first);
+    memcpy(usb_aux_tx_buffer, (uint8_t const *)p_data + first, length - first);
+}
+
+bool usb_aux_frame_send(usb_aux_frame_type_t type,
+                        void const *p_payload,
+                        uint16_t length)
+{
+    uint8_t header[usb_aux_frame_header_size] = {
+        usb_aux_frame_sync,
+        type,
+        (uint8_t)length,
+        (uint8_t)(length >> 8)
+    };
+    bool queued = false;
+
+    CRITICAL_REGION_ENTER();
+
+    if (USB_AUX_TX_BUFFER_SIZE - (usb_aux_tx_head - usb_aux_tx_tail)
+        >= usb_aux_frame_header_size + length)
+    {
+        usb_aux_copy_in(usb_aux_tx_head, header, sizeof(header));
+        usb_aux_copy_in(usb_aux_tx_head + sizeof(header), p_payload, length);
+        usb_aux_tx_head += sizeof(header) + length;
+        queued = true;
+    }
+    else
+    {
+        usb_aux_stats.dropped_frames++;
+        METRIC_INC(usb_aux_dropped_frames);
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    if (queued)
+    {
+        work_signal(WORK_USB_AUX);
+    }
+
+    return queued;
+}
+
+void usb_aux_rx_sink_set(usb_aux_rx_sink_t const *p_sink)
+{
+    p_usb_aux_rx_sink = p_sink;
+    usb_aux_rx_start();
+}
+
+void usb_aux_process(void)
+{
+    usb_aux_tx_start();
+    usb_aux_rx_start();
+}
+
+bool usb_aux_is_open(void)
+{
+    return usb_aux_port_open;
+}
+
+uint32_t usb_aux_tx_pending(void)
+{
+    return usb_aux_tx_head - usb_aux_tx_tail;
+}
+
+void usb_aux_stats_get(usb_aux_stats_t *p_stats)
+{
+    CRITICAL_REGION_ENTER();
+    *p_stats = usb_aux_stats;
+    CRITICAL_REGION_EXIT();
+}
+
+#endif
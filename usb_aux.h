@@ -0,0 +1,70 @@
+#ifndef USB_AUX_H
+#define USB_AUX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sdk_config.h"
+
+/* Auxiliary CDC ACM port for binary streams.
+ *
+ * The port is appended to the USB stack brought up by the text USB log
+ * backend, so the device enumerates as two serial ports: text logs on the
+ * first one, framed binary data on this one. With LOG_BACKEND_BIN_ENABLED
+ * the binary backend replaces the text one, usb_aux_init() brings up the
+ * stack itself and this is the only port.
+ *
+ * Every frame is
+ *
+ *     0xA5 | type | payload length (u16 LE) | payload
+ *
+ * usb_aux_frame_send() may be called from any context. A frame is either
+ * queued whole or dropped when the TX ring has no room for it; the ring is
+ * drained from the main loop through usb_aux_process().
+ *
+ * Bytes the host writes to the port are not framed. They are received
+ * straight into the buffer space of the RX sink, if one is set. When the
+ * sink has no room, reception pauses and the host is held off by USB flow
+ * control. The sink signals WORK_USB_AUX once it has room again. */
+
+enum { usb_aux_frame_sync = 0xA5 };
+
+typedef enum {
+    USB_AUX_FRAME_LOG           = 0x01,
+    USB_AUX_FRAME_LOG_HEXDUMP   = 0x02,
+    USB_AUX_FRAME_LOG_PACKED    = 0x03,
+    USB_AUX_FRAME_METRICS       = 0x04,
+    USB_AUX_FRAME_PROFILE       = 0x05,
+} usb_aux_frame_type_t;
+
+typedef struct {
+    uint32_t tx_bytes;
+    uint32_t dropped_frames;
+} usb_aux_stats_t;
+
+typedef struct {
+    /* room for the next received bytes, *p_length 0 pauses reception */
+    uint8_t *(*get)(uint32_t *p_length);
+    /* length bytes were written to the room returned by get() */
+    void (*put)(uint32_t length);
+} usb_aux_rx_sink_t;
+
+void usb_aux_init(void);
+
+/* the sink is called from the main loop */
+void usb_aux_rx_sink_set(usb_aux_rx_sink_t const *p_sink);
+
+bool usb_aux_frame_send(usb_aux_frame_type_t type,
+                        void const *p_payload,
+                        uint16_t length);
+
+void usb_aux_process(void);
+
+bool usb_aux_is_open(void);
+
+/* bytes queued and not yet confirmed sent to the host */
+uint32_t usb_aux_tx_pending(void);
+
+void usb_aux_stats_get(usb_aux_stats_t *p_stats);
+
+#endif
@@ -0,0 +1,147 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "waveform.h"
+
+#if WAVEFORM_ENABLED
+
+#include "app_util.h"
+#include "app_util_platform.h"
+#include "dsp.h"
+#include "pwm_stream.h"
+
+/* duty values with bit 15 set, as in the fixed duty table */
+enum { waveform_polarity = 0x8000 };
+
+typedef struct {
+    waveform_shape_t shape;
+    uint32_t phase_inc;
+    int32_t amplitude;
+    int16_t const *p_table;
+    uint32_t table_length;
+} waveform_state_t;
+
+static uint16_t waveform_buffers[2 * WAVEFORM_BUFFER_LENGTH];
+
+static waveform_state_t waveform_state;
+static waveform_state_t waveform_next;
+static volatile bool waveform_next_pending;
+
+static uint32_t waveform_phase;
+static uint32_t waveform_rate;
+static uint16_t waveform_top;
+
+static int32_t waveform_sample(waveform_state_t const *p_state, uint32_t phase)
+{
+    int32_t t;
+
+    switch (p_state->shape)
+    {
+        case WAVEFORM_TRIANGLE:
+            t = phase >> 15;
+            if (t > 0xffff)
+            {
+                t = 0x1ffff - t;
+            }
+            return t - 0x8000;
+
+        case WAVEFORM_RAMP:
+            return (int32_t)(phase >> 16) - 0x8000;
+
+        case WAVEFORM_TABLE:
+            return p_state->p_table[((phase >> 16) * p_state->table_length) >> 16];
+
+        default:
+            return 0;
+    }
+}
+
+static void waveform_fill(uint16_t *p_buffer, uint16_t length)
+{
+    waveform_state_t const *p_state = &waveform_state;
+    int16_t *p_samples = (int16_t *)p_buffer;
+    dsp_nco_t nco;
+    uint32_t i;
+
+    if (waveform_next_pending)
+    {
+        waveform_state = waveform_next;
+        waveform_next_pending = false;
+    }
+
+    /* Q15 samples first, turned into duty values in place */
+    if (p_state->shape == WAVEFORM_SINE)
+    {
+        nco.phase = waveform_phase;
+        nco.phase_inc = p_state->phase_inc;
+
+        dsp_nco_q15(&nco, p_samples, length);
+
+        waveform_phase = nco.phase;
+    }
+    else
+    {
+        for (i = 0; i < length; i++)
+        {
+            p_samples[i] = waveform_sample(p_state, waveform_phase);
+            waveform_phase += p_state->phase_inc;
+        }
+    }
+
+    /* a gain is a mix with a silent second input */
+    dsp_mix_q15(p_samples, p_samples, p_state->amplitude, p_samples, 0, length);
+
+    dsp_scale_to_duty(p_buffer, p_samples, waveform_top, waveform_polarity, length);
+}
+
+static void waveform_state_set(waveform_state_t *p_state, waveform_t const *p_wave)
+{
+    p_state->shape = p_wave->shape;
+    p_state->phase_inc = ((uint64_t)p_wave->frequency_mhz << 32) / (waveform_rate * 1000ull);
+    p_state->amplitude = MIN(p_wave->amplitude, 0x7fff);
+    p_state->p_table = p_wave->p_table;
+    p_state->table_length = p_wave->table_length;
+
+    if (p_state->shape == WAVEFORM_TABLE
+        && (p_state->p_table == NULL || p_state->table_length == 0))
+    {
+        p_state->amplitude = 0;
+        p_state->shape = WAVEFORM_RAMP;
+    }
+}
+
+void waveform_start(nrfx_pwm_t const *p_pwm,
+                    uint16_t top_value,
+                    uint32_t pwm_frequency_hz,
+                    waveform_t const *p_wave)
+{
+    uint32_t periods = MAX(pwm_frequency_hz / WAVEFORM_SAMPLE_RATE_HZ, 1);
+
+    waveform_top = top_value;
+    waveform_rate = pwm_frequency_hz / periods;
+    waveform_phase = 0;
+
+    waveform_state_set(&waveform_state, p_wave);
+
+    pwm_stream_start(p_pwm, waveform_buffers, WAVEFORM_BUFFER_LENGTH, periods - 1, waveform_fill);
+}
+
+void waveform_set(waveform_t const *p_wave)
+{
+    waveform_state_t next;
+
+    waveform_state_set(&next, p_wave);
+
+    CRITICAL_REGION_ENTER();
+    waveform_next = next;
+    waveform_next_pending = true;
+    CRITICAL_REGION_EXIT();
+}
+
+uint32_t waveform_sample_rate(void)
+{
+    return waveform_rate;
+}
+
+#endif
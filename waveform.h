@@ -0,0 +1,52 @@
+#ifndef WAVEFORM_H
+#define WAVEFORM_H
+
+#include <stdint.h>
+
+#include "nrfx_pwm.h"
+#include "sdk_config.h"
+
+/* Waveform synthesis into PWM.
+ *
+ * Samples are generated by a 32-bit phase accumulator and streamed as
+ * common-load duty values through two pwm_stream buffers of
+ * WAVEFORM_BUFFER_LENGTH values, so a waveform of any length plays from a
+ * fixed amount of RAM.
+ *
+ * Each sample is held for several PWM periods through the sequence repeats,
+ * so the sample rate is the PWM frequency divided by a whole number, as
+ * close to WAVEFORM_SAMPLE_RATE_HZ as that allows. */
+
+typedef enum {
+    WAVEFORM_SINE,
+    WAVEFORM_TRIANGLE,
+    WAVEFORM_RAMP,
+    WAVEFORM_TABLE,     /* one period of samples in p_table */
+} waveform_shape_t;
+
+typedef struct {
+    waveform_shape_t shape;
+    uint32_t frequency_mhz;     /* output frequency in millihertz */
+    uint16_t amplitude;         /* Q15, 0x7fff swings between 0 and top_value */
+    int16_t const *p_table;     /* Q15 samples, WAVEFORM_TABLE only */
+    uint16_t table_length;
+} waveform_t;
+
+#if WAVEFORM_ENABLED
+
+/* p_pwm must be set up as pwm_stream_start() requires */
+void waveform_start(nrfx_pwm_t const *p_pwm,
+                    uint16_t top_value,
+                    uint32_t pwm_frequency_hz,
+                    waveform_t const *p_wave);
+
+/* may be called once started, takes effect from the next refilled buffer
+ * and keeps the phase */
+void waveform_set(waveform_t const *p_wave);
+
+/* actual sample rate in Hz */
+uint32_t waveform_sample_rate(void);
+
+#endif
+
+#endif
@@ -0,0 +1,84 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "work.h"
+
+#include "app_timer.h"
+#include "nrf.h"
+#include "nrf_atomic.h"
+#include "sdk_config.h"
+
+#define NRF_LOG_MODULE_NAME work
+#define NRF_LOG_LEVEL WORK_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+static nrf_atomic_u32_t work_pending_mask;
+
+static work_stats_t work_stats;
+
+#if WORK_REPORT_PERIOD_MS
+APP_TIMER_DEF(work_report_timer);
+
+static void work_report_timer_handler(void *ctx)
+{
+    work_stats_log();
+}
+#endif
+
+void work_init(void)
+{
+#if WORK_REPORT_PERIOD_MS
+    app_timer_create(&work_report_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     work_report_timer_handler);
+
+    app_timer_start(work_report_timer,
+                    APP_TIMER_TICKS(WORK_REPORT_PERIOD_MS),
+                    NULL);
+#endif
+}
+
+void work_signal(uint32_t work)
+{
+    nrf_atomic_u32_or(&work_pending_mask, work);
+    __SEV();
+}
+
+uint32_t work_take(void)
+{
+    return nrf_atomic_u32_fetch_store(&work_pending_mask, 0);
+}
+
+bool work_pending(void)
+{
+    return work_pending_mask != 0;
+}
+
+void work_loop_account(bool productive)
+{
+    if (productive)
+    {
+        work_stats.productive++;
+    }
+    else
+    {
+        work_stats.wasted++;
+    }
+}
+
+void work_stats_log(void)
+{
+    work_stats_t stats = work_stats;
+
+    NRF_LOG_INFO("loop passes: %u productive, %u wasted",
+                 stats.productive, stats.wasted);
+}
+
+#if NRF_LOG_ENABLED && NRF_LOG_DEFERRED
+/* Called by the log frontend whenever an entry is put into the buffer */
+void log_pending_hook(void)
+{
+    work_signal(WORK_LOG);
+}
+#endif
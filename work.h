@@ -0,0 +1,41 @@
+#ifndef WORK_H
+#define WORK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Pending-work signalling for the main loop.
+ *
+ * Interrupt handlers and hooks call work_signal() with the bits of the
+ * subsystems that have something to do. The main loop takes the whole mask
+ * at once, runs only the flagged subsystems and sleeps when nothing is left.
+ * work_signal() also executes SEV, so a signal raised just before the loop
+ * goes to sleep makes the WFE return immediately. */
+
+typedef enum {
+    WORK_LOG        = 1u << 0,
+    WORK_USB        = 1u << 1,
+    WORK_DISPLAY    = 1u << 2,
+    WORK_USB_AUX    = 1u << 3,
+    WORK_LOG_LANES  = 1u << 4,
+    WORK_CRASH_LOG  = 1u << 5,
+} work_t;
+
+typedef struct {
+    uint32_t productive;        /* loop passes that moved some subsystem forward */
+    uint32_t wasted;            /* loop passes that found nothing to do */
+} work_stats_t;
+
+void work_init(void);
+
+void work_signal(uint32_t work);
+
+uint32_t work_take(void);
+
+bool work_pending(void);
+
+void work_loop_account(bool productive);
+
+void work_stats_log(void);
+
+#endif
@@ -0,0 +1,156 @@
+#include <stdint.h>
+
+#include "ws2812.h"
+
+#if WS2812_ENABLED
+
+#include "app_timer.h"
+#include "app_util.h"
+#include "metrics.h"
+#include "pwm_stream.h"
+#include "scope_profile.h"
+
+#define NRF_LOG_MODULE_NAME ws2812
+#define NRF_LOG_LEVEL WS2812_CONFIG_LOG_LEVEL
+#include "nrf_log.h"
+NRF_LOG_MODULE_REGISTER();
+
+/* high for 0.375 us or 0.8125 us of the 1.25 us bit, bit 15 set makes
+ * the period start high */
+enum { ws2812_bit_0 = 0x8000 | 6 };
+enum { ws2812_bit_1 = 0x8000 | 13 };
+enum { ws2812_low = 0x8000 };
+
+enum { ws2812_bits_per_byte = 8 };
+enum { ws2812_frame_bytes = 3 * WS2812_LEDS };
+enum { ws2812_chunk_values = WS2812_CHUNK_LEDS * 3 * ws2812_bits_per_byte };
+
+/* 1.25 us per value, whole bytes so that every LED starts at a multiple
+ * of 8 values into a buffer */
+enum { ws2812_reset_values = CEIL_DIV(WS2812_RESET_US * 4 / 5, ws2812_bits_per_byte)
+                             * ws2812_bits_per_byte };
+
+enum { ws2812_report_ms = 1000 };
+
+static uint8_t ws2812_frame[ws2812_frame_bytes];    /* G, R, B per LED */
+
+/* the encoder stores four values at a time */
+static uint64_t ws2812_values[2 * ws2812_chunk_values / 4];
+
+/* position in the frame: bytes, then reset values */
+static uint32_t ws2812_byte;
+static uint32_t ws2812_reset_left;
+
+static volatile uint32_t ws2812_frames;
+static uint32_t ws2812_frames_reported;
+
+METRIC_DEF(ws2812_fps, METRIC_GAUGE);
+
+SCOPE_PROFILE_DEF(ws2812_fill);
+
+APP_TIMER_DEF(ws2812_report_timer);
+
+/* four bits, most significant first, as four PWM values */
+#define WS2812_NIBBLE(n)                                                     \
+    (  (uint64_t)(((n) & 8) ? ws2812_bit_1 : ws2812_bit_0)                   \
+     | (uint64_t)(((n) & 4) ? ws2812_bit_1 : ws2812_bit_0) << 16             \
+     | (uint64_t)(((n) & 2) ? ws2812_bit_1 : ws2812_bit_0) << 32             \
+     | (uint64_t)(((n) & 1) ? ws2812_bit_1 : ws2812_bit_0) << 48)
+
+static uint64_t const ws2812_nibbles[16] = {
+    WS2812_NIBBLE(0),  WS2812_NIBBLE(1),  WS2812_NIBBLE(2),  WS2812_NIBBLE(3),
+    WS2812_NIBBLE(4),  WS2812_NIBBLE(5),  WS2812_NIBBLE(6),  WS2812_NIBBLE(7),
+    WS2812_NIBBLE(8),  WS2812_NIBBLE(9),  WS2812_NIBBLE(10), WS2812_NIBBLE(11),
+    WS2812_NIBBLE(12), WS2812_NIBBLE(13), WS2812_NIBBLE(14), WS2812_NIBBLE(15),
+};
+
+static void ws2812_fill(uint16_t *p_values, uint16_t length)
+{
+    uint64_t *p_out = (uint64_t *)p_values;
+    uint32_t i = 0;
+    uint32_t n;
+    uint8_t byte;
+
+    SCOPE_PROFILE_BEGIN(ws2812_fill);
+
+    while (i < length)
+    {
+        if (ws2812_byte < ws2812_frame_bytes)
+        {
+            n = MIN((length - i) / ws2812_bits_per_byte, ws2812_frame_bytes - ws2812_byte);
+
+            for (; n > 0; n--)
+            {
+                byte = ws2812_frame[ws2812_byte++];
+
+                p_out[i / 4] = ws2812_nibbles[byte >> 4];
+                p_out[i / 4 + 1] = ws2812_nibbles[byte & 0x0f];
+                i += ws2812_bits_per_byte;
+            }
+        }
+        else if (ws2812_reset_left > 0)
+        {
+            n = MIN(length - i, ws2812_reset_left);
+
+            ws2812_reset_left -= n;
+
+            for (; n > 0; n--)
+            {
+                p_values[i++] = ws2812_low;
+            }
+        }
+        else
+        {
+            ws2812_frames++;
+            ws2812_byte = 0;
+            ws2812_reset_left = ws2812_reset_values;
+        }
+    }
+
+    SCOPE_PROFILE_END(ws2812_fill);
+}
+
+static void ws2812_report(void *ctx)
+{
+    uint32_t frames = ws2812_frames;
+    uint32_t fps = (frames - ws2812_frames_reported) * 1000 / ws2812_report_ms;
+
+    ws2812_frames_reported = frames;
+
+    METRIC_SET(ws2812_fps, fps);
+
+    NRF_LOG_INFO("%u LEDs, %u frames/s", WS2812_LEDS, fps);
+}
+
+void ws2812_start(nrfx_pwm_t const *p_pwm)
+{
+    ws2812_byte = 0;
+    ws2812_reset_left = ws2812_reset_values;
+
+    app_timer_create(&ws2812_report_timer,
+                     APP_TIMER_MODE_REPEATED,
+                     ws2812_report);
+    app_timer_start(ws2812_report_timer,
+                    APP_TIMER_TICKS(ws2812_report_ms),
+                    NULL);
+
+    pwm_stream_start(p_pwm, (uint16_t *)ws2812_values, ws2812_chunk_values, 0, ws2812_fill);
+}
+
+void ws2812_set(uint32_t led, uint8_t red, uint8_t green, uint8_t blue)
+{
+    uint8_t *p_led;
+
+    if (led >= WS2812_LEDS)
+    {
+        return;
+    }
+
+    p_led = &ws2812_frame[3 * led];
+
+    p_led[0] = green;
+    p_led[1] = red;
+    p_led[2] = blue;
+}
+
+#endif
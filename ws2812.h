@@ -0,0 +1,35 @@
+#ifndef WS2812_H
+#define WS2812_H
+
+#include <stdint.h>
+
+#include "nrfx_pwm.h"
+#include "sdk_config.h"
+
+/* WS2812 LED strip on PWM.
+ *
+ * The frame buffer holds 3 bytes per LED. The PWM needs one 16-bit value
+ * per bit, 48 bytes per LED, so the frame is encoded just in time into
+ * pwm_stream buffers of WS2812_CHUNK_LEDS LEDs and never exists in PWM form
+ * as a whole. RAM use does not depend on the strip length beyond the frame
+ * buffer itself.
+ *
+ * The PWM must run at 800 kHz, one period per bit, from the 16 MHz clock
+ * with a top value of 20. Frames are sent back to back, each followed by
+ * WS2812_RESET_US of low output to latch it, so the strip shows changes
+ * made to the frame buffer at any time within one frame. The frames sent
+ * per second are logged and kept in the ws2812_fps metric; a frame of 300
+ * LEDs takes 9 ms plus the reset time, about 107 frames/s. */
+
+enum { ws2812_top_value = 20 };
+
+#if WS2812_ENABLED
+
+/* p_pwm must be set up as pwm_stream_start() requires */
+void ws2812_start(nrfx_pwm_t const *p_pwm);
+
+void ws2812_set(uint32_t led, uint8_t red, uint8_t green, uint8_t blue);
+
+#endif
+
+#endif